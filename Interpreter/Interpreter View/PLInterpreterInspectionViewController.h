@@ -0,0 +1,115 @@
+/**
+ * \file PLInterpreterInspectionViewController.h
+ * \brief Liasis Python IDE interpreter inspection view controller
+ *
+ * \details This file contains the interface of the view controller displaying
+ *          the pages of an object inspection in a popover.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+#import "PLInterpreterInspection.h"
+
+/**
+ * \class PLInterpreterInspectionViewController \headerfile \headerfile
+ * \brief The view controller displaying an object inspection one page at a
+ *        time.
+ *
+ * \details The view is a read-only text view above a bar with the title of the
+ *          inspection and buttons moving between pages. Only the displayed
+ *          page is held by the text view, so that inspecting a large module
+ *          keeps a single page of text in memory.
+ */
+@interface PLInterpreterInspectionViewController : NSViewController {
+        /**
+         * \brief The displayed inspection.
+         */
+        PLInterpreterInspection * inspection;
+        
+        /**
+         * \brief The zero-based index of the displayed page.
+         */
+        NSUInteger pageIndex;
+        
+        /**
+         * \brief The font of the text view.
+         */
+        NSFont * font;
+        
+        /**
+         * \brief The text view displaying the page.
+         */
+        NSTextView * pageView;
+        
+        /**
+         * \brief The label showing the title and the page number.
+         */
+        NSTextField * pageLabel;
+        
+        /**
+         * \brief The button displaying the previous page.
+         */
+        NSButton * previousButton;
+        
+        /**
+         * \brief The button displaying the next page.
+         */
+        NSButton * nextButton;
+}
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize the view controller with a font.
+ *
+ * \param aFont The font of the displayed pages.
+ *
+ * \return An initialized PLInterpreterInspectionViewController object.
+ */
+-(id)initWithFont:(NSFont *)aFont;
+
+#pragma mark Pages
+
+/**
+ * \brief Display the first page of an inspection.
+ *
+ * \param anInspection The inspection.
+ */
+-(void)setInspection:(PLInterpreterInspection *)anInspection;
+
+/**
+ * \brief Display the previous page of the inspection.
+ *
+ * \param sender The object sending the action.
+ */
+-(IBAction)previousPage:(id)sender;
+
+/**
+ * \brief Display the next page of the inspection.
+ *
+ * \param sender The object sending the action.
+ */
+-(IBAction)nextPage:(id)sender;
+
+@end
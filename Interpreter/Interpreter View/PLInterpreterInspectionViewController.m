@@ -0,0 +1,172 @@
+/**
+ * \file PLInterpreterInspectionViewController.m
+ * \brief Liasis Python IDE interpreter inspection view controller
+ *
+ * \details This file contains the implementation of the view controller
+ *          displaying the pages of an object inspection in a popover.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterInspectionViewController.h"
+
+/**
+ * \brief The size of the view of the inspection.
+ */
+static const NSSize PLInterpreterInspectionViewSize = {600, 420};
+
+/**
+ * \brief The height of the bar below the page.
+ */
+static const CGFloat PLInterpreterInspectionBarHeight = 28;
+
+@implementation PLInterpreterInspectionViewController
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithFont:(NSFont *)aFont
+{
+        self = [super initWithNibName:nil bundle:nil];
+        if (self) {
+                font = [aFont retain];
+        }
+        return self;
+}
+
+/**
+ * \brief Release the inspection, the font and the subviews.
+ */
+-(void)dealloc
+{
+        [inspection release];
+        [font release];
+        [pageView release];
+        [pageLabel release];
+        [previousButton release];
+        [nextButton release];
+        [super dealloc];
+}
+
+/**
+ * \brief Return a borderless button with an image and an action.
+ *
+ * \param imageName The name of the image of the button.
+ *
+ * \param action The action sent to the receiver.
+ *
+ * \param frame The frame of the button.
+ *
+ * \return A new button.
+ */
+-(NSButton *)newButtonWithImageNamed:(NSString *)imageName action:(SEL)action frame:(NSRect)frame
+{
+        NSButton * button = [[NSButton alloc] initWithFrame:frame];
+        [button setImage:[NSImage imageNamed:imageName]];
+        [button setImagePosition:NSImageOnly];
+        [button setBezelStyle:NSRecessedBezelStyle];
+        [button setTarget:self];
+        [button setAction:action];
+        return button;
+}
+
+/**
+ * \brief Create the text view and the bar of the inspection.
+ */
+-(void)loadView
+{
+        NSRect bounds = NSMakeRect(0, 0, PLInterpreterInspectionViewSize.width, PLInterpreterInspectionViewSize.height);
+        NSView * view = [[[NSView alloc] initWithFrame:bounds] autorelease];
+        NSRect pageFrame = NSMakeRect(0, PLInterpreterInspectionBarHeight, NSWidth(bounds), NSHeight(bounds) - PLInterpreterInspectionBarHeight);
+        NSScrollView * scrollView = [[[NSScrollView alloc] initWithFrame:pageFrame] autorelease];
+        
+        [scrollView setHasVerticalScroller:YES];
+        [scrollView setHasHorizontalScroller:YES];
+        [scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+        pageView = [[NSTextView alloc] initWithFrame:[[scrollView contentView] bounds]];
+        [pageView setEditable:NO];
+        [pageView setRichText:NO];
+        [pageView setFont:font];
+        [pageView setHorizontallyResizable:YES];
+        [pageView setMaxSize:NSMakeSize(CGFLOAT_MAX, CGFLOAT_MAX)];
+        [[pageView textContainer] setWidthTracksTextView:NO];
+        [[pageView textContainer] setContainerSize:NSMakeSize(CGFLOAT_MAX, CGFLOAT_MAX)];
+        [scrollView setDocumentView:pageView];
+        [view addSubview:scrollView];
+        
+        previousButton = [self newButtonWithImageNamed:NSImageNameGoLeftTemplate action:@selector(previousPage:) frame:NSMakeRect(4, 3, 28, 22)];
+        nextButton = [self newButtonWithImageNamed:NSImageNameGoRightTemplate action:@selector(nextPage:) frame:NSMakeRect(34, 3, 28, 22)];
+        [view addSubview:previousButton];
+        [view addSubview:nextButton];
+        pageLabel = [[NSTextField alloc] initWithFrame:NSMakeRect(68, 5, NSWidth(bounds) - 72, 18)];
+        [pageLabel setEditable:NO];
+        [pageLabel setSelectable:NO];
+        [pageLabel setBordered:NO];
+        [pageLabel setDrawsBackground:NO];
+        [[pageLabel cell] setLineBreakMode:NSLineBreakByTruncatingMiddle];
+        [pageLabel setAutoresizingMask:NSViewWidthSizable];
+        [view addSubview:pageLabel];
+        [self setView:view];
+}
+
+#pragma mark Pages
+
+/**
+ * \brief Display a page of the inspection and update the bar.
+ *
+ * \param index The zero-based index of the page.
+ */
+-(void)showPageAtIndex:(NSUInteger)index
+{
+        NSString * page = [inspection pageAtIndex:index];
+        [self view];
+        if (page == nil && index != 0)
+                return;
+        pageIndex = index;
+        [pageView setString:(page != nil) ? page : @""];
+        [pageView scrollPoint:NSZeroPoint];
+        [pageLabel setStringValue:[NSString stringWithFormat:@"%@, page %lu", [inspection title], (unsigned long)pageIndex + 1]];
+        [previousButton setEnabled:pageIndex > 0];
+        [nextButton setEnabled:[inspection hasPageAtIndex:pageIndex + 1]];
+}
+
+-(void)setInspection:(PLInterpreterInspection *)anInspection
+{
+        [anInspection retain];
+        [inspection release];
+        inspection = anInspection;
+        [self showPageAtIndex:0];
+}
+
+-(IBAction)previousPage:(id)sender
+{
+        if (pageIndex > 0)
+                [self showPageAtIndex:pageIndex - 1];
+}
+
+-(IBAction)nextPage:(id)sender
+{
+        [self showPageAtIndex:pageIndex + 1];
+}
+
+@end
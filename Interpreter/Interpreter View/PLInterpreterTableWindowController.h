@@ -0,0 +1,89 @@
+/**
+ * \file PLInterpreterTableWindowController.h
+ * \brief Liasis Python IDE interpreter table window controller
+ *
+ * \details This file contains the interface of the window controller of a
+ *          virtualized table of a DataFrame or an array.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+#import "PLInterpreterTable.h"
+
+/**
+ * \class PLInterpreterTableWindowController \headerfile \headerfile
+ * \brief The window controller of a table viewer.
+ *
+ * \details The viewer displays a table in a grid, with the row labels in the
+ *          first column. The grid asks only for the cells of the visible rows
+ *          and columns, which the table reads a page at a time, so that
+ *          scrolling through a large table costs the same as through a small
+ *          one. Clicking a column header shows the statistics of the column
+ *          below the grid.
+ *
+ *          Open viewers are kept by the class until their window is closed.
+ */
+@interface PLInterpreterTableWindowController : NSWindowController <NSTableViewDataSource, NSTableViewDelegate, NSWindowDelegate> {
+        /**
+         * \brief The displayed table.
+         */
+        PLInterpreterTable * table;
+        
+        /**
+         * \brief The grid of the table.
+         */
+        NSTableView * tableView;
+        
+        /**
+         * \brief The field displaying the size of the table or the statistics
+         *        of the selected column.
+         */
+        NSTextField * statusField;
+}
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize the controller and its window.
+ *
+ * \param aTable The displayed table.
+ *
+ * \param title The title of the window.
+ *
+ * \return An initialized PLInterpreterTableWindowController object.
+ */
+-(id)initWithTable:(PLInterpreterTable *)aTable title:(NSString *)title;
+
+#pragma mark Showing Tables
+
+/**
+ * \brief Open a viewer of a table.
+ *
+ * \param aTable The displayed table.
+ *
+ * \param title The title of the window.
+ */
++(void)showTable:(PLInterpreterTable *)aTable title:(NSString *)title;
+
+@end
@@ -0,0 +1,203 @@
+/**
+ * \file PLInterpreterTableWindowController.m
+ * \brief Liasis Python IDE interpreter table window controller
+ *
+ * \details This file contains the implementation of the window controller of a
+ *          virtualized table of a DataFrame or an array.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterTableWindowController.h"
+
+/**
+ * \brief The identifier of the column of the row labels.
+ */
+static NSString * const PLInterpreterTableWindowLabelColumn = @"label";
+
+/**
+ * \brief The height of the status field.
+ */
+static const CGFloat PLInterpreterTableWindowStatusHeight = 22.0;
+
+/**
+ * \brief The open viewers, kept until their window is closed.
+ */
+static NSMutableSet * PLInterpreterTableWindowControllers = nil;
+
+@implementation PLInterpreterTableWindowController
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Add a column to the grid.
+ *
+ * \param identifier The identifier of the column.
+ *
+ * \param title The title of the column.
+ *
+ * \param width The width of the column.
+ */
+-(void)addColumnWithIdentifier:(NSString *)identifier title:(NSString *)title width:(CGFloat)width
+{
+        NSTableColumn * column = [[NSTableColumn alloc] initWithIdentifier:identifier];
+        [[column headerCell] setStringValue:title];
+        [[column dataCell] setFont:[NSFont userFixedPitchFontOfSize:11.0]];
+        [column setWidth:width];
+        [column setEditable:NO];
+        [tableView addTableColumn:column];
+        [column release];
+}
+
+/**
+ * \brief Show the number of rows and columns in the status field.
+ */
+-(void)showTableSize
+{
+        NSString * status = [NSString stringWithFormat:@"%lu rows, %lu columns", (unsigned long)[table rowCount], (unsigned long)[table columnCount]];
+        if ([[table columnNames] count] < [table columnCount])
+                status = [status stringByAppendingFormat:@" (first %lu shown)", (unsigned long)[[table columnNames] count]];
+        [statusField setStringValue:status];
+}
+
+-(id)initWithTable:(PLInterpreterTable *)aTable title:(NSString *)title
+{
+        NSWindow * window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 640, 420)
+                                                         styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask
+                                                           backing:NSBackingStoreBuffered
+                                                             defer:YES] autorelease];
+        NSRect bounds = [[window contentView] bounds], scrollFrame, statusFrame;
+        NSScrollView * scrollView;
+        NSUInteger i;
+        self = [super initWithWindow:window];
+        if (self) {
+                table = [aTable retain];
+                [window setTitle:title];
+                [window setDelegate:self];
+                NSDivideRect(bounds, &statusFrame, &scrollFrame, PLInterpreterTableWindowStatusHeight, NSMinYEdge);
+                statusField = [[NSTextField alloc] initWithFrame:NSInsetRect(statusFrame, 4.0, 3.0)];
+                [statusField setEditable:NO];
+                [statusField setBordered:NO];
+                [statusField setDrawsBackground:NO];
+                [[statusField cell] setLineBreakMode:NSLineBreakByTruncatingTail];
+                [statusField setAutoresizingMask:NSViewWidthSizable | NSViewMaxYMargin];
+                [[window contentView] addSubview:statusField];
+                scrollView = [[[NSScrollView alloc] initWithFrame:scrollFrame] autorelease];
+                [scrollView setHasVerticalScroller:YES];
+                [scrollView setHasHorizontalScroller:YES];
+                [scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+                tableView = [[NSTableView alloc] initWithFrame:[[scrollView contentView] bounds]];
+                [self addColumnWithIdentifier:PLInterpreterTableWindowLabelColumn title:@"" width:80];
+                for (i = 0; i < [[table columnNames] count]; i++)
+                        [self addColumnWithIdentifier:[NSString stringWithFormat:@"%lu", (unsigned long)i]
+                                                title:[[table columnNames] objectAtIndex:i]
+                                                width:100];
+                [tableView setColumnAutoresizingStyle:NSTableViewNoColumnAutoresizing];
+                [tableView setAllowsColumnReordering:NO];
+                [tableView setUsesAlternatingRowBackgroundColors:YES];
+                [tableView setGridStyleMask:NSTableViewSolidVerticalGridLineMask];
+                [tableView setDataSource:self];
+                [tableView setDelegate:self];
+                [scrollView setDocumentView:tableView];
+                [[window contentView] addSubview:scrollView];
+                [self showTableSize];
+        }
+        return self;
+}
+
+/**
+ * \brief Release the table and the views.
+ */
+-(void)dealloc
+{
+        [tableView setDataSource:nil];
+        [tableView setDelegate:nil];
+        [tableView release];
+        [statusField release];
+        [table release];
+        [super dealloc];
+}
+
+#pragma mark Showing Tables
+
++(void)showTable:(PLInterpreterTable *)aTable title:(NSString *)title
+{
+        PLInterpreterTableWindowController * controller = [[PLInterpreterTableWindowController alloc] initWithTable:aTable title:title];
+        if (PLInterpreterTableWindowControllers == nil)
+                PLInterpreterTableWindowControllers = [[NSMutableSet alloc] init];
+        [PLInterpreterTableWindowControllers addObject:controller];
+        [[controller window] center];
+        [controller showWindow:self];
+        [controller release];
+}
+
+#pragma mark NSWindowDelegate
+
+/**
+ * \brief Release the viewer when its window closes.
+ *
+ * \param notification The notification sent by the window.
+ */
+-(void)windowWillClose:(NSNotification *)notification
+{
+        [[self retain] autorelease];
+        [PLInterpreterTableWindowControllers removeObject:self];
+}
+
+#pragma mark NSTableViewDataSource
+
+-(NSInteger)numberOfRowsInTableView:(NSTableView *)aTableView
+{
+        return (NSInteger)[table rowCount];
+}
+
+-(id)tableView:(NSTableView *)aTableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(NSInteger)row
+{
+        if ([[tableColumn identifier] isEqualToString:PLInterpreterTableWindowLabelColumn])
+                return [table labelOfRow:(NSUInteger)row];
+        return [table stringValueAtRow:(NSUInteger)row column:(NSUInteger)[[tableColumn identifier] integerValue]];
+}
+
+#pragma mark NSTableViewDelegate
+
+/**
+ * \brief Show the statistics of a column when its header is clicked, or the
+ *        size of the table for the header of the row labels.
+ *
+ * \param aTableView The grid.
+ *
+ * \param tableColumn The clicked column.
+ */
+-(void)tableView:(NSTableView *)aTableView didClickTableColumn:(NSTableColumn *)tableColumn
+{
+        NSString * statistics;
+        if ([[tableColumn identifier] isEqualToString:PLInterpreterTableWindowLabelColumn]) {
+                [self showTableSize];
+                return;
+        }
+        statistics = [table statisticsOfColumn:(NSUInteger)[[tableColumn identifier] integerValue]];
+        [statusField setStringValue:[NSString stringWithFormat:@"%@: %@", [[tableColumn headerCell] stringValue],
+                                     (statistics == nil) ? @"no statistics" : statistics]];
+}
+
+@end
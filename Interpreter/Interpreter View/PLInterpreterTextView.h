@@ -0,0 +1,56 @@
+/**
+ * \file PLInterpreterTextView.h
+ * \brief Liasis Python IDE interpreter text view interface file.
+ *
+ * \details This file contains the interface for the text view of the
+ *          interpreter. It copies folded lines of output in full.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+
+/**
+ * \class PLInterpreterTextView \headerfile \headerfile
+ * \brief The text view of the interpreter.
+ *
+ * \details This NSTextView subclass writes the full text of folded lines to
+ *          the pasteboard when a selection containing their placeholders is
+ *          copied or dragged.
+ *
+ * \see PLInterpreterFoldedText
+ */
+@interface PLInterpreterTextView : NSTextView
+
+/**
+ * \brief Return the text of a range of the text view with folded lines
+ *        expanded.
+ *
+ * \param aRange The range of characters in the text view.
+ *
+ * \return The text in the range, with each folded line placeholder that lies
+ *         entirely in the range replaced by the full folded line.
+ */
+-(NSString *)expandedStringForRange:(NSRange)aRange;
+
+@end
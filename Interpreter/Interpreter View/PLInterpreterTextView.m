@@ -0,0 +1,89 @@
+/**
+ * \file PLInterpreterTextView.m
+ * \brief Liasis Python IDE interpreter text view implementation file.
+ *
+ * \details This file contains the implementation for the text view of the
+ *          interpreter. It copies folded lines of output in full.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterTextView.h"
+#import "PLInterpreterFoldedText.h"
+
+@implementation PLInterpreterTextView
+
+-(NSString *)expandedStringForRange:(NSRange)aRange
+{
+        NSTextStorage * textStorage = [self textStorage];
+        NSMutableString * expandedString = [NSMutableString string];
+        [textStorage enumerateAttribute:PLInterpreterFoldedTextAttributeName
+                                inRange:aRange
+                                options:NSAttributedStringEnumerationLongestEffectiveRangeNotRequired
+                             usingBlock:^(id value, NSRange range, BOOL *stop) {
+                                     NSRange placeholderRange;
+                                     if (value != nil) {
+                                             [textStorage attribute:PLInterpreterFoldedTextAttributeName
+                                                            atIndex:range.location
+                                              longestEffectiveRange:&placeholderRange
+                                                            inRange:NSMakeRange(0, [textStorage length])];
+                                             if (NSEqualRanges(NSIntersectionRange(placeholderRange, aRange), placeholderRange)) {
+                                                     if (range.location == placeholderRange.location)
+                                                             [expandedString appendString:[value text]];
+                                                     return;
+                                             }
+                                     }
+                                     [expandedString appendString:[[textStorage string] substringWithRange:range]];
+                             }];
+        return expandedString;
+}
+
+/**
+ * \brief Write the selection to the pasteboard with folded lines expanded.
+ *
+ * \details Plain text pasteboard types receive the expanded selection. Other
+ *          types are written by NSTextView.
+ *
+ * \param pboard The pasteboard to write to.
+ *
+ * \param type The pasteboard type to write.
+ *
+ * \return YES if the selection was written, otherwise NO.
+ */
+-(BOOL)writeSelectionToPasteboard:(NSPasteboard *)pboard type:(NSString *)type
+{
+        NSMutableString * selection;
+        NSArray * ranges;
+        if (![type isEqualToString:NSPasteboardTypeString])
+                return [super writeSelectionToPasteboard:pboard type:type];
+        ranges = [self selectedRanges];
+        selection = [NSMutableString string];
+        for (NSValue * range in ranges) {
+                if ([selection length] > 0)
+                        [selection appendString:@"\n"];
+                [selection appendString:[self expandedStringForRange:[range rangeValue]]];
+        }
+        return [pboard setString:selection forType:NSPasteboardTypeString];
+}
+
+@end
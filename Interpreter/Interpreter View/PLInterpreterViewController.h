@@ -32,6 +32,8 @@
 #import <Cocoa/Cocoa.h>
 #import <LiasisKit/LiasisKit.h>
 #import "PLInterpreterController.h"
+#import "PLInterpreterTextView.h"
+#import "PLInterpreterTranscriptExporter.h"
 
 /**
  * \class PLInterpreterViewController \headerfile \headerfile
@@ -44,16 +46,17 @@
  *          handles all opening and saving operations. In addition, the
  *          PLInterpreterViewController provides the theme for interpreter.
  *
- *          Currently, saving and opening interpreter sessions is not supported.
+ *          Interpreter sessions can be exported as a Python script or a
+ *          notebook, but opening interpreter sessions is not supported.
  *
  * \see PLInterpreterController
  */
 @interface PLInterpreterViewController : NSViewController <PLAddOnExtension>
 {
         /**
-         * \brief NSTextView representing the document text view.
+         * \brief PLInterpreterTextView representing the document text view.
          */
-        IBOutlet NSTextView * textView;
+        IBOutlet PLInterpreterTextView * textView;
         
         /**
          * \brief NSScrollView representing the document scroll view.
@@ -172,8 +175,8 @@
  *
  * \details This method is called by the tab view controller when a save as event
  *          is intercepted, either by key equivalents or (TO DO) through the
- *          menu bar. The receiver, the subviw controller, may
- *          choose to take action, or ignore the command.
+ *          menu bar. The interpreter exports its transcript as a Python script
+ *          or a notebook, depending on the extension of the chosen file.
  *
  * \param id sender The object that sent the open message.
  */
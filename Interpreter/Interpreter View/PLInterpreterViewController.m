@@ -57,16 +57,31 @@
         return [self viewController];
 }
 
+/**
+ * \brief Load the interpreter view and apply the theme and font.
+ *
+ * \details The Python side of the interpreter is set up when the view is
+ *          first focused or receives input. The time taken by loading the nib,
+ *          applying the theme and setting the font is logged in milliseconds.
+ */
 - (id)initWithNibName:(NSString *)nibNameOrNil bundle:(NSBundle *)nibBundleOrNil
 {
+        uint64_t start = mach_absolute_time();
+        double nibTime, themeTime, fontTime;
         self = [super initWithNibName:nibNameOrNil bundle:nibBundleOrNil];
         [self loadView];
         if (self) {
                 [interpreterController setPromptAtEnd];
                 [scrollView setVerticalScroller:[[PLScroller new] autorelease]];
                 [(PLScroller *)[scrollView verticalScroller] setDocumentView:textView];
+                nibTime = PLInterpreterMillisecondsSince(start);
+                start = mach_absolute_time();
                 [self updateThemeManager];
+                themeTime = PLInterpreterMillisecondsSince(start);
+                start = mach_absolute_time();
                 [self updateFont:[[NSFontManager sharedFontManager] selectedFont]];
+                fontTime = PLInterpreterMillisecondsSince(start);
+                NSLog(@"Interpreter startup: nib %.2f ms, theme %.2f ms, font %.2f ms", nibTime, themeTime, fontTime);
         }
         return self;
 }
@@ -115,9 +130,35 @@ exit:
         return;
 }
 
+/**
+ * \brief Export the interpreter transcript as a Python script or a notebook.
+ *
+ * \details The format is chosen by the extension of the file, ipynb for a
+ *          notebook and py otherwise.
+ *
+ * \param sender The object that sent the save as message.
+ */
 -(IBAction)saveFileAs:(id)sender
 {
-        return;
+        NSSavePanel * savePanel = [NSSavePanel savePanel];
+        [savePanel setAllowedFileTypes:@[@"py", @"ipynb"]];
+        [savePanel setAllowsOtherFileTypes:NO];
+        [savePanel setNameFieldStringValue:@"Interpreter Session.py"];
+        [savePanel beginSheetModalForWindow:[[self view] window] completionHandler:^(NSInteger result) {
+                PLInterpreterTranscriptExporter * exporter;
+                NSString * path = [[savePanel URL] path];
+                NSError * error = nil;
+                if (result != NSFileHandlingPanelOKButton)
+                        return;
+                exporter = [[PLInterpreterTranscriptExporter alloc] initWithTextStorage:[textView textStorage]
+                                                                        transcriptIndex:[interpreterController transcriptIndex]];
+                if (![exporter writeToPath:path format:[PLInterpreterTranscriptExporter formatForPath:path] error:&error])
+                        [[NSAlert alertWithError:error] beginSheetModalForWindow:[[self view] window]
+                                                                   modalDelegate:nil
+                                                                  didEndSelector:NULL
+                                                                     contextInfo:NULL];
+                [exporter release];
+        }];
 }
 
 -(id)document
@@ -130,7 +171,8 @@ exit:
 /**
  * \brief NSResponder method prior to accepting first responder status.
  *
- * \details Set the window's first responder to the textView.
+ * \details Set the window's first responder to the textView, and set up the
+ *          Python side of the interpreter the first time the view is focused.
  *
  * \return Always return YES, indicating that the view controller accepted
  *         first responder status.
@@ -138,6 +180,7 @@ exit:
 -(BOOL)becomeFirstResponder
 {
         [[[self view] window] makeFirstResponder:textView];
+        [interpreterController setUpInterpreter];
         return YES;
 }
 
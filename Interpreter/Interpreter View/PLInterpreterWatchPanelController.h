@@ -0,0 +1,88 @@
+/**
+ * \file PLInterpreterWatchPanelController.h
+ * \brief Liasis Python IDE interpreter watch panel
+ *
+ * \details This file contains the interface of the window controller of the
+ *          panel displaying the watch expressions of the interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+#import "PLInterpreterWatchList.h"
+
+/**
+ * \class PLInterpreterWatchPanelController \headerfile \headerfile
+ * \brief The window controller of the panel displaying the watch expressions
+ *        and their values.
+ *
+ * \details The panel is a floating utility panel beside the interpreter
+ *          window, with a table of the expressions and their last values, so
+ *          that the values are not written to the transcript. Selected
+ *          expressions are removed with the Delete menu item.
+ */
+@interface PLInterpreterWatchPanelController : NSWindowController <NSTableViewDataSource, NSTableViewDelegate> {
+        /**
+         * \brief The displayed watch list.
+         */
+        PLInterpreterWatchList * watchList;
+        
+        /**
+         * \brief The table of the expressions and their values.
+         */
+        NSTableView * tableView;
+}
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize the controller and its panel.
+ *
+ * \param aWatchList The displayed watch list.
+ *
+ * \return An initialized PLInterpreterWatchPanelController object.
+ */
+-(id)initWithWatchList:(PLInterpreterWatchList *)aWatchList;
+
+#pragma mark Displaying Values
+
+/**
+ * \brief Show the panel beside a window, unless it is already visible.
+ *
+ * \param window The interpreter window.
+ */
+-(void)showBesideWindow:(NSWindow *)window;
+
+/**
+ * \brief Display the current expressions and values.
+ */
+-(void)reloadData;
+
+/**
+ * \brief Remove the selected expressions from the watch list.
+ *
+ * \param sender The object sending the action.
+ */
+-(IBAction)delete:(id)sender;
+
+@end
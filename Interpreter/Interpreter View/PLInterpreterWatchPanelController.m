@@ -0,0 +1,148 @@
+/**
+ * \file PLInterpreterWatchPanelController.m
+ * \brief Liasis Python IDE interpreter watch panel
+ *
+ * \details This file contains the implementation of the window controller of
+ *          the panel displaying the watch expressions of the interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterWatchPanelController.h"
+
+/**
+ * \brief The identifier of the expression column.
+ */
+static NSString * const PLInterpreterWatchPanelExpressionColumn = @"expression";
+
+/**
+ * \brief The identifier of the value column.
+ */
+static NSString * const PLInterpreterWatchPanelValueColumn = @"value";
+
+@implementation PLInterpreterWatchPanelController
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Add a column to the table.
+ *
+ * \param identifier The identifier of the column.
+ *
+ * \param title The title of the column.
+ *
+ * \param width The width of the column.
+ */
+-(void)addColumnWithIdentifier:(NSString *)identifier title:(NSString *)title width:(CGFloat)width
+{
+        NSTableColumn * column = [[NSTableColumn alloc] initWithIdentifier:identifier];
+        [[column headerCell] setStringValue:title];
+        [column setWidth:width];
+        [column setEditable:NO];
+        [tableView addTableColumn:column];
+        [column release];
+}
+
+-(id)initWithWatchList:(PLInterpreterWatchList *)aWatchList
+{
+        NSPanel * panel = [[[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 360, 240)
+                                                      styleMask:NSTitledWindowMask | NSClosableWindowMask | NSResizableWindowMask | NSUtilityWindowMask
+                                                        backing:NSBackingStoreBuffered
+                                                          defer:YES] autorelease];
+        NSScrollView * scrollView;
+        self = [super initWithWindow:panel];
+        if (self) {
+                watchList = [aWatchList retain];
+                [panel setTitle:@"Watches"];
+                [panel setFloatingPanel:YES];
+                [panel setHidesOnDeactivate:YES];
+                scrollView = [[[NSScrollView alloc] initWithFrame:[[panel contentView] bounds]] autorelease];
+                [scrollView setHasVerticalScroller:YES];
+                [scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+                tableView = [[NSTableView alloc] initWithFrame:[[scrollView contentView] bounds]];
+                [self addColumnWithIdentifier:PLInterpreterWatchPanelExpressionColumn title:@"Expression" width:140];
+                [self addColumnWithIdentifier:PLInterpreterWatchPanelValueColumn title:@"Value" width:200];
+                [tableView setColumnAutoresizingStyle:NSTableViewLastColumnOnlyAutoresizingStyle];
+                [tableView setAllowsMultipleSelection:YES];
+                [tableView setUsesAlternatingRowBackgroundColors:YES];
+                [tableView setDataSource:self];
+                [tableView setDelegate:self];
+                [scrollView setDocumentView:tableView];
+                [[panel contentView] addSubview:scrollView];
+        }
+        return self;
+}
+
+/**
+ * \brief Release the watch list and the table.
+ */
+-(void)dealloc
+{
+        [tableView setDataSource:nil];
+        [tableView setDelegate:nil];
+        [tableView release];
+        [watchList release];
+        [super dealloc];
+}
+
+#pragma mark Displaying Values
+
+-(void)showBesideWindow:(NSWindow *)window
+{
+        NSRect frame = [window frame];
+        if ([[self window] isVisible])
+                return;
+        [[self window] setFrameTopLeftPoint:NSMakePoint(NSMaxX(frame), NSMaxY(frame))];
+        [[self window] orderFront:self];
+}
+
+-(void)reloadData
+{
+        [tableView reloadData];
+}
+
+-(IBAction)delete:(id)sender
+{
+        NSArray * watches = [[watchList watches] objectsAtIndexes:[tableView selectedRowIndexes]];
+        for (PLInterpreterWatch * watch in watches)
+                [watchList removeExpression:[watch expression]];
+        [tableView deselectAll:self];
+}
+
+#pragma mark NSTableViewDataSource
+
+-(NSInteger)numberOfRowsInTableView:(NSTableView *)aTableView
+{
+        return (NSInteger)[[watchList watches] count];
+}
+
+-(id)tableView:(NSTableView *)aTableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(NSInteger)row
+{
+        PLInterpreterWatch * watch = [[watchList watches] objectAtIndex:(NSUInteger)row];
+        if ([[tableColumn identifier] isEqualToString:PLInterpreterWatchPanelExpressionColumn])
+                return [watch expression];
+        return [watch valueString];
+}
+
+@end
@@ -0,0 +1,124 @@
+/**
+ * \file PLInterpreterArraySummary.h
+ * \brief Liasis Python IDE interpreter array summary
+ *
+ * \details This file contains the interface of the background summary of the
+ *          values of an array exposing the buffer protocol.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+#import "PLInterpreterOutputSink.h"
+
+/**
+ * \class PLInterpreterArraySummary \headerfile \headerfile
+ * \brief Summarize the values of an array in the background.
+ *
+ * \details The minimum, maximum, mean and number of NaN values of an object
+ *          exposing a contiguous buffer of numbers, such as a numpy array, are
+ *          computed by vectorized Accelerate kernels reading the buffer
+ *          directly. Nothing is called on the object besides getting its
+ *          buffer, and the summary runs on a background queue without the
+ *          global interpreter lock, so that summarizing a large array does not
+ *          block the prompt.
+ *
+ *          The array is read in chunks. The progress is written to the output
+ *          sink after each chunk, on a line overwritten with a carriage
+ *          return, and the summary replaces it when it is complete. Chunks
+ *          without NaN values are summarized by the vectorized kernels alone,
+ *          and only chunks containing NaN values are read again by a scalar
+ *          loop skipping them.
+ */
+@interface PLInterpreterArraySummary : NSObject {
+        /**
+         * \brief The buffer of the array, held until the summary is
+         *        complete.
+         */
+        Py_buffer buffer;
+        
+        /**
+         * \brief The type code of the values of the buffer, without its byte
+         *        order prefix.
+         */
+        char typeCode;
+        
+        /**
+         * \brief The name of the array in the summary.
+         */
+        NSString * name;
+        
+        /**
+         * \brief The output sink the progress and the summary are written to.
+         */
+        PLInterpreterOutputSink * outputSink;
+        
+        /**
+         * \brief The smallest value that is not NaN.
+         */
+        double minimum;
+        
+        /**
+         * \brief The largest value that is not NaN.
+         */
+        double maximum;
+        
+        /**
+         * \brief The sum of the values that are not NaN.
+         */
+        double sum;
+        
+        /**
+         * \brief The number of values that are not NaN.
+         */
+        uint64_t count;
+        
+        /**
+         * \brief The number of NaN values.
+         */
+        uint64_t nanCount;
+}
+
+#pragma mark Summarizing Arrays
+
+/**
+ * \brief Start summarizing an array in the background.
+ *
+ * \details The global interpreter lock must be held. The buffer of the array
+ *          is held until the summary is written to the output sink. Arrays
+ *          are summarized one at a time, in the order they are passed.
+ *
+ * \param object An object exposing a contiguous buffer of integers or floating
+ *               point numbers.
+ *
+ * \param arrayName The name of the array in the summary.
+ *
+ * \param sink The output sink the progress and the summary are written to.
+ *
+ * \return YES if the summary started, or NO with a Python exception set if the
+ *         object has no such buffer.
+ */
++(BOOL)summarizeObject:(PyObject *)object name:(NSString *)arrayName toSink:(PLInterpreterOutputSink *)sink;
+
+@end
@@ -0,0 +1,271 @@
+/**
+ * \file PLInterpreterArraySummary.m
+ * \brief Liasis Python IDE interpreter array summary
+ *
+ * \details This file contains the implementation of the background summary of
+ *          the values of an array exposing the buffer protocol.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterArraySummary.h"
+#import <Accelerate/Accelerate.h>
+
+/**
+ * \brief The number of values summarized between two progress updates.
+ */
+static const vDSP_Length PLInterpreterArraySummaryChunkLength = 1 << 20;
+
+/**
+ * \brief Return the serial queue summarizing arrays.
+ *
+ * \details Summaries run one at a time, so that the progress lines of two
+ *          summaries do not overwrite each other in the output.
+ *
+ * \return The summary queue.
+ */
+static dispatch_queue_t PLInterpreterArraySummaryQueue(void)
+{
+        static dispatch_queue_t queue = NULL;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                queue = dispatch_queue_create("org.liasis.interpreter.summary", DISPATCH_QUEUE_SERIAL);
+        });
+        return queue;
+}
+
+@implementation PLInterpreterArraySummary
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize a summary of a buffer.
+ *
+ * \details The summary takes over the buffer, and releases it when it is
+ *          deallocated.
+ *
+ * \param aBuffer The buffer of the array.
+ *
+ * \param aTypeCode The type code of the values of the buffer.
+ *
+ * \param arrayName The name of the array in the summary.
+ *
+ * \param sink The output sink the progress and the summary are written to.
+ *
+ * \return An initialized PLInterpreterArraySummary object.
+ */
+-(id)initWithBuffer:(Py_buffer *)aBuffer typeCode:(char)aTypeCode name:(NSString *)arrayName sink:(PLInterpreterOutputSink *)sink
+{
+        self = [super init];
+        if (self == nil) {
+                PyBuffer_Release(aBuffer);
+                return nil;
+        }
+        buffer = *aBuffer;
+        typeCode = aTypeCode;
+        name = [arrayName copy];
+        outputSink = [sink retain];
+        minimum = INFINITY;
+        maximum = -INFINITY;
+        return self;
+}
+
+/**
+ * \brief Release the buffer of the array, taking the global interpreter lock.
+ */
+-(void)dealloc
+{
+        PyGILState_STATE state = PyGILState_Ensure();
+        PyBuffer_Release(&buffer);
+        PyGILState_Release(state);
+        [name release];
+        [outputSink release];
+        [super dealloc];
+}
+
+#pragma mark Summarizing Arrays
+
+/**
+ * \brief Add a chunk of values to the summary.
+ *
+ * \details The chunk is summed by a vectorized kernel. A NaN sum means that
+ *          the chunk contains a NaN value, or infinities of both signs, and
+ *          only then is the chunk read again by a scalar loop skipping NaN
+ *          values.
+ *
+ * \param values The values of the chunk.
+ *
+ * \param length The number of values of the chunk.
+ */
+-(void)summarizeValues:(const double *)values length:(vDSP_Length)length
+{
+        double chunkSum = 0.0, chunkMinimum, chunkMaximum;
+        vDSP_Length i;
+        vDSP_sveD(values, 1, &chunkSum, length);
+        if (isnan(chunkSum)) {
+                for (i = 0; i < length; i++) {
+                        if (isnan(values[i])) {
+                                nanCount++;
+                                continue;
+                        }
+                        minimum = fmin(minimum, values[i]);
+                        maximum = fmax(maximum, values[i]);
+                        sum += values[i];
+                        count++;
+                }
+                return;
+        }
+        vDSP_minvD(values, 1, &chunkMinimum, length);
+        vDSP_maxvD(values, 1, &chunkMaximum, length);
+        minimum = fmin(minimum, chunkMinimum);
+        maximum = fmax(maximum, chunkMaximum);
+        sum += chunkSum;
+        count += length;
+}
+
+/**
+ * \brief Summarize the buffer and write the summary to the output sink.
+ *
+ * \details Run on a background queue, without the global interpreter lock.
+ *          Values that are not doubles are converted chunk by chunk into a
+ *          scratch buffer of doubles.
+ */
+-(void)summarize
+{
+        NSAutoreleasePool * pool = [[NSAutoreleasePool alloc] init];
+        vDSP_Length length = (vDSP_Length)(buffer.len / buffer.itemsize), start, chunkLength, i;
+        double * scratch = NULL;
+        const double * values;
+        const char * bytes = buffer.buf;
+        NSString * text, * prefix = (length > PLInterpreterArraySummaryChunkLength) ? @"\r" : @"";
+        if (typeCode != 'd')
+                scratch = malloc(sizeof(double) * MIN(length, PLInterpreterArraySummaryChunkLength));
+        for (start = 0; start < length; start += chunkLength) {
+                chunkLength = MIN(length - start, PLInterpreterArraySummaryChunkLength);
+                values = scratch;
+                switch (typeCode) {
+                        case 'd':
+                                values = (const double *)bytes + start;
+                                break;
+                        case 'f':
+                                vDSP_vspdp((const float *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'b':
+                                vDSP_vflt8D((const char *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'B':
+                                vDSP_vfltu8D((const unsigned char *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'h':
+                                vDSP_vflt16D((const short *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'H':
+                                vDSP_vfltu16D((const unsigned short *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'i':
+                                vDSP_vflt32D((const int *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'I':
+                                vDSP_vfltu32D((const unsigned int *)bytes + start, 1, scratch, 1, chunkLength);
+                                break;
+                        case 'q':
+                                for (i = 0; i < chunkLength; i++)
+                                        scratch[i] = (double)((const int64_t *)bytes)[start + i];
+                                break;
+                        case 'Q':
+                                for (i = 0; i < chunkLength; i++)
+                                        scratch[i] = (double)((const uint64_t *)bytes)[start + i];
+                                break;
+                }
+                [self summarizeValues:values length:chunkLength];
+                if (length > PLInterpreterArraySummaryChunkLength) {
+                        text = [NSString stringWithFormat:@"\r%@: %3d%%", name, (int)(100 * (start + chunkLength) / length)];
+                        [outputSink appendBytes:[text UTF8String] length:strlen([text UTF8String])];
+                }
+        }
+        free(scratch);
+        if (count == 0)
+                text = [NSString stringWithFormat:@"%@%@: no values, NaN count=%llu\n", prefix, name,
+                        (unsigned long long)nanCount];
+        else
+                text = [NSString stringWithFormat:@"%@%@: min=%.17g, max=%.17g, mean=%.17g, NaN count=%llu\n",
+                        prefix, name, minimum, maximum, sum / (double)count, (unsigned long long)nanCount];
+        [outputSink appendBytes:[text UTF8String] length:strlen([text UTF8String])];
+        [pool drain];
+}
+
++(BOOL)summarizeObject:(PyObject *)object name:(NSString *)arrayName toSink:(PLInterpreterOutputSink *)sink
+{
+        PLInterpreterArraySummary * summary;
+        Py_buffer objectBuffer;
+        const char * format;
+        Py_ssize_t expectedSize;
+        char code;
+        if (!PyObject_CheckBuffer(object)) {
+                PyErr_Format(PyExc_TypeError, "%.200s object does not support the buffer protocol", Py_TYPE(object)->tp_name);
+                return NO;
+        }
+        if (PyObject_GetBuffer(object, &objectBuffer, PyBUF_ND | PyBUF_FORMAT | PyBUF_ANY_CONTIGUOUS) != 0)
+                return NO;
+        format = (objectBuffer.format == NULL) ? "B" : objectBuffer.format;
+        if (*format == '@' || *format == '=' || (*format == '<' && NSHostByteOrder() == NS_LittleEndian))
+                format++;
+        code = format[0];
+        switch (code) {
+                case 'd': case 'q': case 'Q':
+                        expectedSize = 8;
+                        break;
+                case 'f': case 'i': case 'I':
+                        expectedSize = 4;
+                        break;
+                case 'h': case 'H':
+                        expectedSize = 2;
+                        break;
+                case 'b': case 'B': case '?':
+                        expectedSize = 1;
+                        break;
+                case 'l': case 'L':
+                        expectedSize = sizeof(long);
+                        code = (sizeof(long) == 8) ? (char)(code + ('q' - 'l')) : (char)(code + ('i' - 'l'));
+                        break;
+                default:
+                        expectedSize = 0;
+                        break;
+        }
+        if (expectedSize == 0 || format[1] != '\0' || objectBuffer.itemsize != expectedSize) {
+                PyErr_Format(PyExc_TypeError, "cannot summarize values of format '%.20s'", objectBuffer.format);
+                PyBuffer_Release(&objectBuffer);
+                return NO;
+        }
+        summary = [[PLInterpreterArraySummary alloc] initWithBuffer:&objectBuffer
+                                                           typeCode:(code == '?') ? 'B' : code
+                                                               name:arrayName
+                                                               sink:sink];
+        dispatch_async(PLInterpreterArraySummaryQueue(), ^{
+                [summary summarize];
+                [summary release];
+        });
+        return YES;
+}
+
+@end
@@ -33,6 +33,16 @@
 #import <Python/Python.h>
 #import <LiasisKit/LiasisKit.h>
 #import "PLInterpreterHistory.h"
+#import "PLInterpreterOutputSink.h"
+#import "PLInterpreterOutputParser.h"
+#import "PLInterpreterTranscriptIndex.h"
+#import "PLInterpreterTranscriptSearch.h"
+#import "PLInterpreterJournal.h"
+#import "PLInterpreterTiming.h"
+#import "PLInterpreterDebugger.h"
+#import "PLInterpreterWatchList.h"
+
+@class PLInterpreterWatchPanelController;
 
 /**
  * \class PLInterpreterController \headerfile \headerfile
@@ -45,24 +55,63 @@
  *          initializes a Python interpreter on startup. This class controls
  *          sending commands to that interpreter from the user by translating
  *          NSString objects to PyObject C structs. It supports single-input and
- *          multiline input. Output is handled by redirecting stdout and stderr
- *          from the interpreter to a Python object defined by this class.
+ *          multiline input.
+ *
+ *          Lines starting with '%' are magic commands implemented by the
+ *          bundled liasis_magics module; %magics lists them. Lines starting
+ *          with '!' are run by the shell, with $name replaced by the value of a
+ *          global, and their output is streamed into the view while they run.
+ *
+ *          Output is handled by redirecting stdout and stderr from the
+ *          interpreter to a Python object defined by this class, which writes
+ *          to a native output sink. Optionally, the stdout and stderr file
+ *          descriptors are captured as well, so that output from C extensions
+ *          and child processes reaches the same sink. Output written between
+ *          commands, for example by background Python threads, is displayed
+ *          above the current prompt. ANSI colors in the output are displayed,
+ *          and carriage returns overwrite the current line.
  *
  *          This class stores a recallable history of input entries accessible
- *          with the directional arrows. It limits user input to the current
- *          line and prevents deletion of the interpreter prompt.
+ *          with the directional arrows. Typing an opening parenthesis after a
+ *          callable shows its signature, and entering a name followed by ? or
+ *          ?? shows its documentation or source in a paged popover. It limits
+ *          user input to the current line and prevents deletion of the
+ *          interpreter prompt. Only edits to the current input can be undone.
+ *
+ *          The lines and commands of the transcript are indexed, so that the
+ *          view can move between commands, and the transcript can be searched
+ *          without blocking the interface. Every command is journaled to disk,
+ *          and the session is restored after a crash. Optionally, each command
+ *          is checked for undefined names before it runs.
+ *
+ *          Commands run with %debug pause at breakpoints and are debugged from
+ *          the view, and the expressions added with %watch are shown in a panel
+ *          beside it.
  *
  * \todo Implement real autocomplete.
  * \todo Fix interfacing with matplotlib (or other graphical packages)
  *
  */
-@interface PLInterpreterController : NSObject <NSTextViewDelegate> {
+@interface PLInterpreterController : NSObject <NSTextViewDelegate, PLInterpreterDebuggerDelegate> {
         /**
          * \brief The location of the interpreter prompt. Used to restrict
          *        editing to only after the prompt.
          */
         NSUInteger promptLocation;
         
+        /**
+         * \brief The location where the interpreter prompt begins. Output
+         *        written between commands is inserted before this location.
+         */
+        NSUInteger promptStartLocation;
+        
+        /**
+         * \brief Whether or not a newline was inserted before the prompt to
+         *        end a partial line of output written between commands. The
+         *        next output continues the partial line before the newline.
+         */
+        BOOL promptNewlineInserted;
+        
         /**
          * \brief Store the history of each input to the interpreter.
          */
@@ -92,6 +141,24 @@
          */
         PyObject * pyOutputCatcher;
         
+        /**
+         * \brief The output sink that the output catcher and the file
+         *        descriptor capture write to.
+         */
+        PLInterpreterOutputSink * outputSink;
+        
+        /**
+         * \brief The parser interpreting escape sequences and carriage returns
+         *        in the output before it is added to the interpreter view.
+         */
+        PLInterpreterOutputParser * outputParser;
+        
+        /**
+         * \brief Whether or not the Python side of the interpreter is set
+         *        up.
+         */
+        BOOL interpreterSetUp;
+        
         /**
          * \brief The __main__ module for the interpreter. Use this to provide
          * the globals dict for each input expression.
@@ -102,8 +169,122 @@
          * \brief Append to this string to provide support for multiline input.
         */
         NSMutableString * multilineInputString;
+        
+        /**
+         * \brief The undo manager of the interpreter view, covering only the
+         *        edits to the current input.
+         *
+         * \details Output appended by the controller is never registered for
+         *          undo. The undo stack is bounded, and it is cleared whenever
+         *          the input is submitted or replaced, or the text before the
+         *          input changes, since the recorded ranges would no longer be
+         *          valid.
+         */
+        NSUndoManager * inputUndoManager;
+        
+        /**
+         * \brief The index of the lines and commands of the interpreter
+         *        transcript, updated as the interpreter view is edited.
+         */
+        PLInterpreterTranscriptIndex * transcriptIndex;
+        
+        /**
+         * \brief The location of the prompt of the first line of the command
+         *        being entered.
+         */
+        NSUInteger commandPromptLocation;
+        
+        /**
+         * \brief The search of the interpreter transcript, indexed in the
+         *        background.
+         */
+        PLInterpreterTranscriptSearch * transcriptSearch;
+        
+        /**
+         * \brief The string of the last transcript search.
+         */
+        NSString * searchString;
+        
+        /**
+         * \brief The ranges of the matches of the last transcript search, in
+         *        transcript order, as NSValue objects.
+         */
+        NSMutableArray * searchMatches;
+        
+        /**
+         * \brief The popover showing the signature of the callable being
+         *        called, created when first needed.
+         */
+        NSPopover * signaturePopover;
+        
+        /**
+         * \brief Incremented for every signature lookup, so that only the
+         *        result of the latest lookup is shown.
+         */
+        NSUInteger signatureRequest;
+        
+        /**
+         * \brief The popover showing the pages of an object inspection,
+         *        created when first needed.
+         */
+        NSPopover * inspectionPopover;
+        
+        /**
+         * \brief The recent object inspections, keyed by the inspected file
+         *        lines or documentation.
+         */
+        NSCache * inspectionCache;
+        
+        /**
+         * \brief The last command not run because it failed the check of
+         *        undefined names. Entering it again runs it without the check.
+         */
+        NSString * uncheckedCommand;
+        
+        /**
+         * \brief The frame of the paused debugged command, or NULL if no
+         *        command is paused.
+         */
+        PyFrameObject * debugFrame;
+        
+        /**
+         * \brief How the paused debugged command resumes.
+         */
+        PLInterpreterDebuggerAction debugAction;
+        
+        /**
+         * \brief The global names used by the last command, or nil if they
+         *        are not known. Only the watch expressions reading these
+         *        names or rebound names are evaluated after the command.
+         */
+        NSSet * commandNames;
+        
+        /**
+         * \brief The controller of the panel displaying the watch
+         *        expressions, created when first needed.
+         */
+        PLInterpreterWatchPanelController * watchPanelController;
+        
+        /**
+         * \brief The output of the running magic command already written to
+         *        the view to show its progress, or nil if none was written.
+         */
+        NSMutableString * progressOutput;
+        
+        /**
+         * \brief The end of the input of the running magic command, valid
+         *        once its progress is written.
+         */
+        NSUInteger progressInputEndLocation;
 }
 
+#pragma mark Properties
+
+/**
+ * \brief The index of the lines and commands of the interpreter transcript.
+ */
+@property(readonly) PLInterpreterTranscriptIndex * transcriptIndex;
+
 /**
  * \brief Add the prompt symbol to the end of the interpreter.
  *
@@ -112,4 +293,66 @@
  */
 -(void)setPromptAtEnd;
 
+/**
+ * \brief Set up the Python side of the interpreter, if it is not set up yet.
+ *
+ * \details The python interpreter creates an internal object and sets stdout
+ *          and stderr to write to that object. This is done by importing the
+ *          sys module and creating a class that implements a method 'write' to
+ *          pass a string to the native output sink. By setting sys.stdout and
+ *          sys.stderr, this object writes all iterpreter output to the sink.
+ *          If enabled in the user defaults, the stdout and stderr file
+ *          descriptors are captured into the same sink. The startup file of
+ *          the user is then run, unless it is deferred in the user defaults
+ *          until the prompt is displayed.
+ *
+ *          Setting up is deferred until the interpreter is first focused or
+ *          first receives input, and the time taken is logged in milliseconds.
+ */
+-(void)setUpInterpreter;
+
+/**
+ * \brief Display the output of the running magic command and check for the
+ *        interrupt key.
+ *
+ * \details Magic commands running for a long time call this method regularly,
+ *          through the native interpreter module, since they hold the main
+ *          thread. The output written so far is displayed below the command.
+ *
+ * \return YES if the interrupt key was pressed since the last call, otherwise
+ *         NO, including when no magic command is running.
+ */
++(BOOL)displayProgressOfRunningCommand;
+
+/**
+ * \brief Select the input of the command preceding the selection.
+ *
+ * \details The command boundaries are found in the transcript index, and the
+ *          input of the command is selected and scrolled to.
+ *
+ * \param sender The object sending the action.
+ */
+-(IBAction)selectPreviousCommand:(id)sender;
+
+/**
+ * \brief Select the input of the command following the selection.
+ *
+ * \details If there is no following command, the insertion point is moved to
+ *          the current prompt.
+ *
+ * \param sender The object sending the action.
+ */
+-(IBAction)selectNextCommand:(id)sender;
+
+/**
+ * \brief Search the transcript for the string value of the sender.
+ *
+ * \details The search runs in the background, and its matches are
+ *          highlighted as they are found. The first match is selected. Sending
+ *          the same string again selects the next match.
+ *
+ * \param sender The search field sending the action.
+ */
+-(IBAction)searchTranscript:(id)sender;
+
 @end
@@ -29,7 +29,19 @@
  * \date 2012-2014.
  */
 
+#import <CommonCrypto/CommonDigest.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#import <Python/marshal.h>
 #import "PLInterpreterController.h"
+#import "PLInterpreterFileDescriptorCapture.h"
+#import "PLInterpreterPythonModule.h"
+#import "PLInterpreterInspectionViewController.h"
+#import "PLInterpreterNameCheck.h"
+#import "PLInterpreterWatchPanelController.h"
 
 #pragma mark Interpreter Prompts
 
@@ -43,10 +55,261 @@ NSString * const PLInterpreterControllerPromptString = @">>> ";
  */
 NSString * const PLInterpreterControllerContinuationPromptString = @"... ";
 
+/**
+ * \brief The prompt string while a debugged command is paused.
+ */
+NSString * const PLInterpreterControllerDebugPromptString = @"(debug) ";
+
+/**
+ * \brief The prefix of input lines handled as magic commands.
+ */
+NSString * const PLInterpreterControllerMagicPrefix = @"%";
+
+/**
+ * \brief The prefix of input lines run as shell commands.
+ */
+NSString * const PLInterpreterControllerShellPrefix = @"!";
+
+/**
+ * \brief The name of the bundled Python module implementing the magic
+ *        commands.
+ */
+static const char * PLInterpreterControllerMagicModuleName = "liasis_magics";
+
+/**
+ * \brief The name of the bundled Python module resolving hints about the
+ *        objects of the namespace.
+ */
+static const char * PLInterpreterControllerIntrospectionModuleName = "liasis_introspection";
+
+/**
+ * \brief The pattern of an inspection command: a dotted name followed by ?
+ *        for its documentation or ?? for its source.
+ */
+NSString * const PLInterpreterControllerInspectionPattern = @"^\\s*([A-Za-z_][A-Za-z0-9_]*(\\.[A-Za-z_][A-Za-z0-9_]*)*)(\\?\\??)\\s*$";
+
+/**
+ * \brief The number of inspections kept in the inspection cache.
+ */
+static const NSUInteger PLInterpreterControllerInspectionCacheCount = 32;
+
+#pragma mark Completion Worker
+
+/**
+ * \brief Return the serial queue running Python lookups for hints, away from
+ *        the keystrokes.
+ *
+ * \details The queue takes the global interpreter lock, which the main thread
+ *          releases while it waits for events.
+ *
+ * \return The completion queue.
+ */
+static dispatch_queue_t PLInterpreterControllerCompletionQueue(void)
+{
+        static dispatch_queue_t queue = NULL;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                queue = dispatch_queue_create("org.liasis.interpreter.completion", DISPATCH_QUEUE_SERIAL);
+        });
+        return queue;
+}
+
+#pragma mark User Defaults
+
+/**
+ * \brief The user defaults key enabling capture of the stdout and stderr file
+ *        descriptors, in addition to sys.stdout and sys.stderr.
+ */
+NSString * const PLInterpreterControllerCaptureFileDescriptorsKey = @"PLInterpreterCaptureFileDescriptors";
+
+/**
+ * \brief The user defaults key for the length beyond which a line of output is
+ *        folded.
+ */
+NSString * const PLInterpreterControllerFoldedLineLengthKey = @"PLInterpreterFoldedLineLength";
+
+/**
+ * \brief The length beyond which a line of output is folded, if not set in the
+ *        user defaults.
+ */
+static const NSUInteger PLInterpreterControllerDefaultFoldedLineLength = 10000;
+
+/**
+ * \brief The user defaults key for the array of names of the modules imported
+ *        in the background when the first interpreter is created.
+ */
+NSString * const PLInterpreterControllerPreloadedModulesKey = @"PLInterpreterPreloadedModules";
+
+/**
+ * \brief The user defaults key for the path of the Python file run before the
+ *        first command. If not set, the PYTHONSTARTUP environment variable is
+ *        used.
+ */
+NSString * const PLInterpreterControllerStartupFileKey = @"PLInterpreterStartupFile";
+
+/**
+ * \brief The user defaults key deferring the startup file until after the
+ *        first prompt is displayed.
+ */
+NSString * const PLInterpreterControllerDeferStartupFileKey = @"PLInterpreterDeferStartupFile";
+
+/**
+ * \brief The user defaults key enabling the check of undefined names before
+ *        each command runs.
+ */
+NSString * const PLInterpreterControllerCheckNamesKey = @"PLInterpreterCheckNames";
+
+/**
+ * \brief The user defaults key for the time budget of the evaluation of each
+ *        watch expression, in milliseconds.
+ */
+NSString * const PLInterpreterControllerWatchBudgetKey = @"PLInterpreterWatchBudget";
+
+/**
+ * \brief The time budget of each watch expression, in milliseconds, if it is
+ *        not set in the user defaults.
+ */
+static const NSInteger PLInterpreterControllerDefaultWatchBudget = 50;
+
+#pragma mark Startup File
+
+/**
+ * \brief Whether or not the startup file was run. The interpreters share
+ *        __main__, so it is run once per process.
+ */
+static BOOL PLInterpreterControllerStartupFileRun = NO;
+
+/**
+ * \brief Log a startup message, which must not reach the interpreter when the
+ *        file descriptors are captured.
+ *
+ * \param format The format of the message, followed by its arguments.
+ */
+static void PLInterpreterControllerLog(NSString * format, ...)
+{
+        NSString * message;
+        va_list arguments;
+        va_start(arguments, format);
+        message = [[NSString alloc] initWithFormat:format arguments:arguments];
+        va_end(arguments);
+        [[PLInterpreterFileDescriptorCapture sharedCapture] logMessage:message];
+        [message release];
+}
+
+#pragma mark Shell Commands
+
+/**
+ * \brief The path of the shell running shell commands.
+ */
+static const char * PLInterpreterControllerShellPath = "/bin/sh";
+
+/**
+ * \brief The size of the buffer used for each read of shell command output.
+ */
+static const size_t PLInterpreterControllerShellReadSize = 64*1024;
+
+/**
+ * \brief The interval, in milliseconds, between displays of the output of a
+ *        running shell command, and between checks for the interrupt key.
+ */
+static const int PLInterpreterControllerShellDisplayInterval = 50;
+
+/**
+ * \brief The environment of the process, passed to shell commands.
+ */
+extern char ** environ;
+
+/**
+ * \brief Return the length of the UTF-8 bytes read so far that do not end
+ *        in the middle of a character.
+ *
+ * \param bytes The bytes read.
+ *
+ * \param length The number of bytes read.
+ *
+ * \return The length of the bytes without a trailing partial character.
+ */
+static NSUInteger PLInterpreterControllerCompleteUTF8Length(const unsigned char * bytes, NSUInteger length)
+{
+        NSUInteger start = length, needed;
+        while (start > 0 && length - start < 3 && (bytes[start - 1] & 0xC0) == 0x80)
+                start--;
+        if (start == 0)
+                return length;
+        needed = (bytes[start - 1] >= 0xF0) ? 4 : (bytes[start - 1] >= 0xE0) ? 3 : (bytes[start - 1] >= 0xC0) ? 2 : 1;
+        return (length - (start - 1) >= needed) ? length : start - 1;
+}
+
+#pragma mark Input Undo
+
+/**
+ * \brief The maximum number of undo groups kept for the current input.
+ */
+static const NSUInteger PLInterpreterControllerInputLevelsOfUndo = 100;
+
+#pragma mark Background Output
+
+/**
+ * \brief The interval, in seconds, at which output written between commands
+ *        is displayed.
+ */
+static const int64_t PLInterpreterControllerBackgroundOutputInterval = NSEC_PER_SEC/10;
+
+/**
+ * \brief The interpreter controller displaying output written between
+ *        commands. This is the controller that most recently ran a command,
+ *        and it is not retained.
+ */
+static PLInterpreterController * PLInterpreterControllerBackgroundOutputController = nil;
+
+/**
+ * \brief The interpreter controller running a magic command, or nil. Output
+ *        is not displayed as background output while a magic command runs,
+ *        since it belongs to the command.
+ */
+static PLInterpreterController * PLInterpreterControllerRunningMagicController = nil;
+
+/**
+ * \brief The thread state of the main thread while the main run loop waits
+ *        without holding the Python global interpreter lock.
+ */
+static PyThreadState * PLInterpreterControllerIdleThreadState = NULL;
+
+/**
+ * \brief Release the global interpreter lock while the main run loop waits.
+ *
+ * \details The main thread holds the global interpreter lock, so background
+ *          Python threads could otherwise only run while a command executes.
+ *          The lock is released before the run loop waits for events and
+ *          reacquired as soon as it wakes up, before any timer or source that
+ *          may call into Python is handled.
+ *
+ * \param observer The run loop observer.
+ *
+ * \param activity The run loop activity, kCFRunLoopBeforeWaiting or
+ *                 kCFRunLoopAfterWaiting.
+ *
+ * \param info Unused.
+ */
+static void PLInterpreterControllerRunLoopObserverCallBack(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void * info)
+{
+        if (activity == kCFRunLoopBeforeWaiting) {
+                if (PLInterpreterControllerIdleThreadState == NULL && PyEval_ThreadsInitialized())
+                        PLInterpreterControllerIdleThreadState = PyEval_SaveThread();
+        } else if (activity == kCFRunLoopAfterWaiting) {
+                if (PLInterpreterControllerIdleThreadState != NULL) {
+                        PyEval_RestoreThread(PLInterpreterControllerIdleThreadState);
+                        PLInterpreterControllerIdleThreadState = NULL;
+                }
+        }
+}
+
 #pragma mark -
 
 @implementation PLInterpreterController
 
+@synthesize transcriptIndex;
+
 #pragma mark Initialization and Deallocation
 
 /**
@@ -59,44 +322,521 @@ NSString * const PLInterpreterControllerContinuationPromptString = @"... ";
 }
 
 /**
- * \brief Release the history and multiline instance variables, decrement the
- *        pyOutputCatcher Python object, and finalize the Python interpreter.
+ * \brief Release the history, multiline and output sink instance variables,
+ *        decrement the pyOutputCatcher Python object, and finalize the Python
+ *        interpreter.
  */
 -(void)dealloc
 {
-        Py_DECREF(pyOutputCatcher);
+        [[NSNotificationCenter defaultCenter] removeObserver:self];
+        if (PLInterpreterControllerBackgroundOutputController == self)
+                PLInterpreterControllerBackgroundOutputController = nil;
+        Py_XDECREF(pyOutputCatcher);
+        [outputSink release];
+        [outputParser release];
         [historyObject release];
         [multilineInputString release];
+        [inputUndoManager release];
+        [transcriptIndex release];
+        [transcriptSearch cancelSearch];
+        [transcriptSearch release];
+        [searchString release];
+        [searchMatches release];
+        [signaturePopover close];
+        [signaturePopover release];
+        [inspectionPopover close];
+        [inspectionPopover release];
+        [inspectionCache release];
+        [uncheckedCommand release];
+        [commandNames release];
+        [progressOutput release];
+        [watchPanelController close];
+        [watchPanelController release];
+        if ([[PLInterpreterDebugger sharedDebugger] delegate] == self)
+                [[PLInterpreterDebugger sharedDebugger] setDelegate:nil];
         [super dealloc];
 }
 
 /**
- * \brief Initialize the prompt and python interpreter.
+ * \brief Initialize the prompt and the native state of the interpreter.
  *
- * \details Upon initialization, the python interpreter creates an internal
- *          object and sets stdout and stderr to write to that object. This is
- *          done by importing the sys module and creating a class that
- *          implements a method 'write' to append a string to its internal
- *          string instance variable. By setting sys.stdout and sys.stderr, this
- *          object writes all iterpreter output to its instance variable.
+ * \details The Python side of the interpreter is set up lazily by
+ *          setUpInterpreter, so that an interpreter that is never used does not
+ *          pay for it. Lines of output longer than the folded line length in
+ *          the user defaults are folded. Create the bounded undo manager for
+ *          the input and start indexing the transcript. If the previous session
+ *          crashed, its journaled commands are restored. Observe the watch list
+ *          to show the watch panel. Finally, start displaying output written
+ *          between commands and preloading the modules named in the user
+ *          defaults.
  */
 -(void)awakeFromNib
 {
+        NSInteger foldedLineLength;
         promptLocation = 3;
+        promptStartLocation = 0;
         
+        outputSink = [[PLInterpreterOutputSink sharedSink] retain];
+        outputParser = [[PLInterpreterOutputParser alloc] init];
+        foldedLineLength = [[NSUserDefaults standardUserDefaults] integerForKey:PLInterpreterControllerFoldedLineLengthKey];
+        [outputParser setFoldingLength:(foldedLineLength > 0) ? (NSUInteger)foldedLineLength : PLInterpreterControllerDefaultFoldedLineLength];
+        promptNewlineInserted = NO;
+        interpreterSetUp = NO;
+        pyMainModule = NULL;
+        pyOutputCatcher = NULL;
+        historyObject = [[PLInterpreterHistory alloc] initWithHistoryLength:20];
+        multilineInputString = [[NSMutableString alloc] initWithString:@""];
+        inputUndoManager = [[NSUndoManager alloc] init];
+        [inputUndoManager setLevelsOfUndo:PLInterpreterControllerInputLevelsOfUndo];
+        transcriptIndex = [[PLInterpreterTranscriptIndex alloc] initWithString:[interpreterView string]];
+        commandPromptLocation = 0;
+        transcriptSearch = [[PLInterpreterTranscriptSearch alloc] init];
+        searchString = nil;
+        searchMatches = [[NSMutableArray alloc] init];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(textStorageDidProcessEditing:)
+                                                     name:NSTextStorageDidProcessEditingNotification
+                                                   object:[interpreterView textStorage]];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationWillTerminate:)
+                                                     name:NSApplicationWillTerminateNotification
+                                                   object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(watchListDidChange:)
+                                                     name:PLInterpreterWatchListDidChangeNotification
+                                                   object:nil];
+        [self restoreRecoveredSession];
+        if (PLInterpreterControllerBackgroundOutputController == nil)
+                PLInterpreterControllerBackgroundOutputController = self;
+        [PLInterpreterController startDisplayingBackgroundOutput];
+        [PLInterpreterController preloadModules];
+}
+
+-(void)setUpInterpreter
+{
+        NSError * error = nil;
+        PyObject * resourcePath;
+        uint64_t start;
+        if (interpreterSetUp)
+                return;
+        interpreterSetUp = YES;
+        start = mach_absolute_time();
+        PLInterpreterPythonModuleInitialize();
         pyMainModule = PyImport_AddModule("__main__");
         PyRun_SimpleString("import sys\n"
+                           "import _liasis_interpreter\n"
                            "class __CatchOutErr:\n"
-                           "    def __init__(self):\n"
-                           "        self.value = ''\n"
                            "    def write(self, txt):\n"
-                           "        self.value += txt\n"
+                           "        _liasis_interpreter.write(txt)\n"
+                           "    def flush(self):\n"
+                           "        pass\n"
                            "__catchOutErr = __CatchOutErr()\n"
                            "sys.stdout = __catchOutErr\n"
                            "sys.stderr = __catchOutErr\n");
         pyOutputCatcher = PyObject_GetAttrString(pyMainModule, "__catchOutErr");
-        historyObject = [[PLInterpreterHistory alloc] initWithHistoryLength:20];
-        multilineInputString = [[NSMutableString alloc] initWithString:@""];
+        resourcePath = PyString_FromString([[[NSBundle bundleForClass:[self class]] resourcePath] fileSystemRepresentation]);
+        PyList_Insert(PySys_GetObject("path"), 0, resourcePath);
+        Py_DECREF(resourcePath);
+        PyEval_InitThreads();
+        if ([[NSUserDefaults standardUserDefaults] boolForKey:PLInterpreterControllerCaptureFileDescriptorsKey]) {
+                if (![[PLInterpreterFileDescriptorCapture sharedCapture] startCapturingToSink:outputSink error:&error])
+                        NSLog(@"Could not capture stdout and stderr file descriptors: %@", error);
+        }
+        PLInterpreterControllerLog(@"Interpreter startup: Python setup %.2f ms", PLInterpreterMillisecondsSince(start));
+        if ([[NSUserDefaults standardUserDefaults] boolForKey:PLInterpreterControllerDeferStartupFileKey])
+                [self performSelector:@selector(runStartupFile) withObject:nil afterDelay:0.0];
+        else
+                [self runStartupFile];
+}
+
+#pragma mark Startup File
+
+/**
+ * \brief Return the code object of the startup file, from the cache if
+ *        possible.
+ *
+ * \details The code object is cached in the Liasis folder of the caches
+ *          directory, keyed by the SHA-1 digest of the path, the contents of
+ *          the file and the magic number of the Python bytecode, so that an
+ *          edited file or a different Python is compiled again.
+ *
+ * \param path The path of the startup file.
+ *
+ * \param contents The contents of the startup file.
+ *
+ * \param cached On return, whether or not the code object was cached.
+ *
+ * \return A new reference to the code object, or NULL with a Python
+ *         exception set if the file could not be compiled.
+ */
+-(PyObject *)codeOfStartupFile:(NSString *)path contents:(NSData *)contents cached:(BOOL *)cached
+{
+        unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+        long magic = PyImport_GetMagicNumber();
+        NSMutableString * cacheName = [NSMutableString string];
+        NSMutableData * source;
+        NSString * cachePath;
+        NSData * cacheData;
+        PyObject * code = NULL, * marshalled;
+        CC_SHA1_CTX context;
+        int i;
+        
+        CC_SHA1_Init(&context);
+        CC_SHA1_Update(&context, [path fileSystemRepresentation], (CC_LONG)strlen([path fileSystemRepresentation]));
+        CC_SHA1_Update(&context, &magic, sizeof(magic));
+        CC_SHA1_Update(&context, [contents bytes], (CC_LONG)[contents length]);
+        CC_SHA1_Final(digest, &context);
+        for (i = 0; i < CC_SHA1_DIGEST_LENGTH; i++)
+                [cacheName appendFormat:@"%02x", digest[i]];
+        cachePath = [[NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0] stringByAppendingPathComponent:@"Liasis"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:cachePath withIntermediateDirectories:YES attributes:nil error:NULL];
+        cachePath = [cachePath stringByAppendingPathComponent:[cacheName stringByAppendingPathExtension:@"marshal"]];
+        
+        *cached = NO;
+        cacheData = [NSData dataWithContentsOfFile:cachePath];
+        if (cacheData != nil) {
+                code = PyMarshal_ReadObjectFromString((char *)[cacheData bytes], (Py_ssize_t)[cacheData length]);
+                if (code != NULL && PyCode_Check(code)) {
+                        *cached = YES;
+                        goto exit;
+                }
+                Py_XDECREF(code);
+                PyErr_Clear();
+        }
+        source = [NSMutableData dataWithData:contents];
+        [source appendBytes:"\0" length:1];
+        code = Py_CompileString([source bytes], [path fileSystemRepresentation], Py_file_input);
+        if (code == NULL)
+                goto exit;
+        marshalled = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+        if (marshalled != NULL)
+                [[NSData dataWithBytes:PyString_AS_STRING(marshalled) length:(NSUInteger)PyString_GET_SIZE(marshalled)] writeToFile:cachePath atomically:YES];
+        else
+                PyErr_Clear();
+        Py_XDECREF(marshalled);
+exit:
+        return code;
+}
+
+/**
+ * \brief Run the startup file in __main__, if it was not run yet.
+ *
+ * \details The startup file is named in the user defaults, or by the
+ *          PYTHONSTARTUP environment variable. Its output is displayed as
+ *          output written between commands, and the time taken is logged in
+ *          milliseconds.
+ */
+-(void)runStartupFile
+{
+        NSString * path = [[NSUserDefaults standardUserDefaults] stringForKey:PLInterpreterControllerStartupFileKey];
+        PyObject * code, * result, * dict;
+        NSData * contents;
+        BOOL cached = NO;
+        uint64_t start;
+        
+        if (PLInterpreterControllerStartupFileRun)
+                return;
+        PLInterpreterControllerStartupFileRun = YES;
+        if (path == nil)
+                path = [[[NSProcessInfo processInfo] environment] objectForKey:@"PYTHONSTARTUP"];
+        if (path == nil)
+                return;
+        path = [path stringByExpandingTildeInPath];
+        contents = [NSData dataWithContentsOfFile:path];
+        if (contents == nil) {
+                PLInterpreterControllerLog(@"Could not read the interpreter startup file %@", path);
+                return;
+        }
+        start = mach_absolute_time();
+        dict = PyModule_GetDict(pyMainModule);
+        code = [self codeOfStartupFile:path contents:contents cached:&cached];
+        if (code != NULL) {
+                result = PyEval_EvalCode((PyCodeObject *)code, dict, dict);
+                Py_XDECREF(result);
+                Py_DECREF(code);
+        }
+        if (PyErr_Occurred())
+                PyErr_Print();
+        PLInterpreterControllerLog(@"Interpreter startup: startup file %.2f ms (%@)", PLInterpreterMillisecondsSince(start), cached ? @"cached" : @"compiled");
+}
+
+#pragma mark Module Preloading
+
+/**
+ * \brief Import the modules named in the user defaults in the background.
+ *
+ * \details All interpreters share the Python process, so a module imported
+ *          once is in sys.modules for every interpreter, and importing it
+ *          again is immediate. The modules are imported once per process on a
+ *          background thread, which only holds the global interpreter lock
+ *          while the main thread waits for events or lets other Python threads
+ *          run.
+ */
++(void)preloadModules
+{
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                NSArray * moduleNames = [[NSUserDefaults standardUserDefaults] arrayForKey:PLInterpreterControllerPreloadedModulesKey];
+                if ([moduleNames count] == 0)
+                        return;
+                PyEval_InitThreads();
+                [NSThread detachNewThreadSelector:@selector(importModules:)
+                                         toTarget:self
+                                       withObject:[[moduleNames copy] autorelease]];
+        });
+}
+
+/**
+ * \brief Import modules, logging the time taken by each. Runs on a
+ *        background thread.
+ *
+ * \param moduleNames The names of the modules.
+ */
++(void)importModules:(NSArray *)moduleNames
+{
+        PyGILState_STATE state;
+        PyObject * module;
+        uint64_t start;
+        NSAutoreleasePool * pool = [[NSAutoreleasePool alloc] init];
+        for (NSString * moduleName in moduleNames) {
+                if (![moduleName isKindOfClass:[NSString class]])
+                        continue;
+                start = mach_absolute_time();
+                state = PyGILState_Ensure();
+                module = PyImport_ImportModule([moduleName UTF8String]);
+                if (module == NULL)
+                        PyErr_Clear();
+                Py_XDECREF(module);
+                PyGILState_Release(state);
+                if (module == NULL)
+                        PLInterpreterControllerLog(@"Could not preload module %@", moduleName);
+                else
+                        PLInterpreterControllerLog(@"Interpreter startup: preloaded %@ in %.2f ms", moduleName, PLInterpreterMillisecondsSince(start));
+        }
+        [pool drain];
+}
+
+#pragma mark Session Journal
+
+/**
+ * \brief Restore the commands of a previous session that did not exit
+ *        cleanly.
+ *
+ * \details The journaled commands are appended to the transcript before the
+ *          first prompt, indexed, and added to the input history. The recovered
+ *          session is only restored once, by the first interpreter.
+ */
+-(void)restoreRecoveredSession
+{
+        PLInterpreterJournal * journal = [PLInterpreterJournal sharedJournal];
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        NSDictionary * attributes = [self outputAttributes];
+        PLInterpreterTranscriptCommand command;
+        NSString * input, * line;
+        NSArray * lines;
+        NSUInteger i;
+        
+        if ([journal recoveredEntries] == nil)
+                return;
+        [textStorage beginEditing];
+        [outputParser writeString:@"# Restored from the previous session, which did not exit cleanly.\n"
+                       attributes:attributes
+                    toTextStorage:textStorage
+                          atIndex:[textStorage length]];
+        for (NSDictionary * entry in [journal recoveredEntries]) {
+                input = [entry objectForKey:PLInterpreterJournalInputKey];
+                lines = [input componentsSeparatedByString:@"\n"];
+                command.promptLocation = [textStorage length];
+                for (i = 0; i < [lines count]; i++) {
+                        line = [lines objectAtIndex:i];
+                        if (i > 0 && i == [lines count] - 1 && [line length] == 0)
+                                break;
+                        if (i > 0)
+                                [outputParser writeString:@"\n" attributes:attributes toTextStorage:textStorage atIndex:[textStorage length]];
+                        [outputParser writeString:(i == 0) ? PLInterpreterControllerPromptString : PLInterpreterControllerContinuationPromptString
+                                       attributes:attributes
+                                    toTextStorage:textStorage
+                                          atIndex:[textStorage length]];
+                        [textStorage appendAttributedString:[[[NSAttributedString alloc] initWithString:line attributes:attributes] autorelease]];
+                        [historyObject addEntry:line];
+                }
+                command.inputRange = NSMakeRange(command.promptLocation + [PLInterpreterControllerPromptString length],
+                                                 [textStorage length] - command.promptLocation - [PLInterpreterControllerPromptString length]);
+                [outputParser writeString:@"\n" attributes:attributes toTextStorage:textStorage atIndex:[textStorage length]];
+                [outputParser writeString:[entry objectForKey:PLInterpreterJournalOutputKey]
+                               attributes:attributes
+                            toTextStorage:textStorage
+                                  atIndex:[textStorage length]];
+                command.outputRange = NSMakeRange(NSMaxRange(command.inputRange) + 1, [textStorage length] - NSMaxRange(command.inputRange) - 1);
+                [transcriptIndex addCommand:command];
+        }
+        [textStorage endEditing];
+        [outputParser reset];
+        [journal discardRecoveredEntries];
+}
+
+/**
+ * \brief Close the journal when the application terminates cleanly, so that
+ *        the session is not restored on the next launch.
+ *
+ * \param notification The NSApplicationWillTerminateNotification.
+ */
+-(void)applicationWillTerminate:(NSNotification *)notification
+{
+        [[PLInterpreterJournal sharedJournal] close];
+}
+
+#pragma mark Background Output
+
+/**
+ * \brief Start displaying output written between commands.
+ *
+ * \details Install the run loop observer releasing the global interpreter lock
+ *          while the main thread is idle, and a timer on the main queue that
+ *          displays pending output in the most recently used interpreter. This
+ *          is done once per process.
+ */
++(void)startDisplayingBackgroundOutput
+{
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                CFRunLoopObserverRef observer;
+                dispatch_source_t timer;
+                observer = CFRunLoopObserverCreate(kCFAllocatorDefault,
+                                                   kCFRunLoopBeforeWaiting | kCFRunLoopAfterWaiting,
+                                                   true, 0,
+                                                   PLInterpreterControllerRunLoopObserverCallBack,
+                                                   NULL);
+                CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopCommonModes);
+                CFRelease(observer);
+                timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+                dispatch_source_set_timer(timer,
+                                          dispatch_time(DISPATCH_TIME_NOW, PLInterpreterControllerBackgroundOutputInterval),
+                                          PLInterpreterControllerBackgroundOutputInterval,
+                                          PLInterpreterControllerBackgroundOutputInterval/10);
+                dispatch_source_set_event_handler(timer, ^{
+                        [PLInterpreterControllerBackgroundOutputController displayBackgroundOutput];
+                });
+                dispatch_resume(timer);
+        });
+}
+
+/**
+ * \brief Display output written since the last command above the prompt.
+ *
+ * \details Drain the output sink and write the output before the prompt, so
+ *          that the prompt and the input being typed move down unchanged. If
+ *          the output ends with a partial line, a newline is inserted before
+ *          the prompt, and the next output continues the partial line. This
+ *          keeps progress bars redrawn with carriage returns on a single line.
+ *          While a multiline command is being entered, the output is written
+ *          above the first line of the command instead, ending with a newline,
+ *          so that it never becomes part of the command. The selection and
+ *          the recorded start of the command are moved with the input.
+ */
+-(void)displayBackgroundOutput
+{
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        NSString * output;
+        NSAttributedString * newline;
+        NSRange selectedRange;
+        NSUInteger insertionIndex, endIndex, previousLength, anchorLocation;
+        NSInteger offset;
+        if (PLInterpreterControllerRunningMagicController != nil || ![outputSink hasPendingOutput])
+                goto exit;
+        output = [outputSink drainString];
+        if ([output length] == 0)
+                goto exit;
+        selectedRange = [interpreterView selectedRange];
+        previousLength = [textStorage length];
+        if ([multilineInputString length] > 0) {
+                anchorLocation = insertionIndex = commandPromptLocation;
+                endIndex = [outputParser writeString:output
+                                          attributes:[self outputAttributes]
+                                       toTextStorage:textStorage
+                                             atIndex:insertionIndex];
+                if (endIndex > insertionIndex && [[textStorage string] characterAtIndex:endIndex - 1] != '\n') {
+                        newline = [[NSAttributedString alloc] initWithString:@"\n" attributes:[self outputAttributes]];
+                        [textStorage insertAttributedString:newline atIndex:endIndex];
+                        [newline release];
+                }
+                offset = (NSInteger)[textStorage length] - (NSInteger)previousLength;
+                promptStartLocation += offset;
+                goto shift;
+        }
+        anchorLocation = promptStartLocation;
+        insertionIndex = promptNewlineInserted ? promptStartLocation - 1 : promptStartLocation;
+        endIndex = [outputParser writeString:output
+                                  attributes:[self outputAttributes]
+                               toTextStorage:textStorage
+                                     atIndex:insertionIndex];
+        if (endIndex == insertionIndex && [textStorage length] == previousLength)
+                goto exit;
+        if (promptNewlineInserted && endIndex > 0 && [[textStorage string] characterAtIndex:endIndex - 1] == '\n') {
+                [textStorage deleteCharactersInRange:NSMakeRange(endIndex, 1)];
+                promptNewlineInserted = NO;
+        } else if (!promptNewlineInserted && endIndex > 0 && [[textStorage string] characterAtIndex:endIndex - 1] != '\n') {
+                newline = [[NSAttributedString alloc] initWithString:@"\n" attributes:[self outputAttributes]];
+                [textStorage insertAttributedString:newline atIndex:endIndex];
+                [newline release];
+                promptNewlineInserted = YES;
+        }
+        promptStartLocation = promptNewlineInserted ? endIndex + 1 : endIndex;
+        offset = (NSInteger)[textStorage length] - (NSInteger)previousLength;
+shift:
+        [self discardInputUndo];
+        promptLocation += offset;
+        if (commandPromptLocation >= insertionIndex)
+                commandPromptLocation += offset;
+        if (selectedRange.location >= anchorLocation)
+                selectedRange.location += offset;
+        [interpreterView setSelectedRange:selectedRange];
+exit:
+        return;
+}
+
+/**
+ * \brief Return the default text attributes of the interpreter output.
+ *
+ * \return A dictionary containing the font and text color of the interpreter
+ *         view.
+ */
+-(NSDictionary *)outputAttributes
+{
+        return [NSDictionary dictionaryWithObjectsAndKeys:
+                [interpreterView font], NSFontAttributeName,
+                [interpreterView textColor], NSForegroundColorAttributeName,
+                nil];
+}
+
+#pragma mark Input Undo
+
+/**
+ * \brief Provide the undo manager of the interpreter view.
+ *
+ * \details The interpreter view uses the controller's bounded undo manager
+ *          instead of the window's, so that its undo records do not build up
+ *          for the life of the window.
+ *
+ * \param view The interpreter view.
+ *
+ * \return The undo manager for edits to the current input.
+ */
+-(NSUndoManager *)undoManagerForTextView:(NSTextView *)view
+{
+        return inputUndoManager;
+}
+
+/**
+ * \brief Remove all undo records of the current input.
+ *
+ * \details This is called whenever the input is submitted or replaced by the
+ *          controller, or the text before the input changes.
+ */
+-(void)discardInputUndo
+{
+        [interpreterView breakUndoCoalescing];
+        [inputUndoManager removeAllActions];
 }
 
 #pragma mark Interpreter Prompt
@@ -117,48 +857,393 @@ NSString * const PLInterpreterControllerContinuationPromptString = @"... ";
                               [interpreterView font], NSFontAttributeName,
                               [interpreterView textColor], NSForegroundColorAttributeName,
                               nil]];
+        promptStartLocation = [textStorage length];
+        promptNewlineInserted = NO;
+        if ([promptString isEqualToString:PLInterpreterControllerPromptString])
+                commandPromptLocation = promptStartLocation;
         [textStorage appendAttributedString:prompt];
         promptLocation = [[textStorage string] length];
         [prompt release];
 }
 
--(void)setPromptAtEnd
+-(void)setPromptAtEnd
+{
+        [self setPromptAtEnd:PLInterpreterControllerPromptString];
+}
+
+#pragma mark Process Interpreter Input
+
+/**
+ * \brief Execute statement in the python interpreter and return output string.
+ *
+ * \details This method accepts an NSString as input and passes it to the python
+ *          interpreter as a UTF8 string. Using the internally defined and
+ *          created pythonobject to catch stdout and stderr, this method
+ *          retrieves the python output and returns it as an NSString. If an
+ *          executed statement displays no output in the interpreter, this
+ *          method returns an empty string. When the file descriptors are
+ *          captured, the method waits for the native output written during
+ *          the command before draining the output sink. The source of the
+ *          command is registered with linecache under a file name of its own,
+ *          so that the lines of functions it defines can be displayed later.
+ *
+ *          If enabled in the user defaults, the compiled command is checked
+ *          for global names that are neither defined by the command, nor in
+ *          the globals, nor builtins, before it runs, so that a long command
+ *          does not fail with a NameError at its end. A command failing the
+ *          check is not run, and entering the same command again runs it
+ *          anyway.
+ *
+ * \param inputString The string passed to the interpreter.
+ *
+ * \return The output from running the command in the interpreter.
+ */
+-(NSString *)runPythonCommand:(NSString *)inputString
+{
+        PyObject * code, * result, * dict, * module, * filename = NULL;
+        NSArray * undefinedNames;
+        if ([inputString isEqualToString:@""])
+                return @"";
+        [self setUpInterpreter];
+        [self runStartupFile];
+        dict = PyModule_GetDict(pyMainModule);
+        module = PyImport_ImportModule(PLInterpreterControllerIntrospectionModuleName);
+        if (module != NULL)
+                filename = PyObject_CallMethod(module, "register_input", "s", [inputString UTF8String]);
+        PyErr_Clear();
+        code = Py_CompileString([inputString UTF8String],
+                                (filename != NULL && PyString_Check(filename)) ? PyString_AS_STRING(filename) : "<string>",
+                                Py_single_input);
+        Py_XDECREF(filename);
+        Py_XDECREF(module);
+        if (code == NULL)
+                goto exit;
+        [commandNames release];
+        commandNames = [[PLInterpreterNameCheck globalNamesInCode:(PyCodeObject *)code] retain];
+        if ([[NSUserDefaults standardUserDefaults] boolForKey:PLInterpreterControllerCheckNamesKey]
+            && [inputString isEqualToString:uncheckedCommand] == NO) {
+                undefinedNames = [PLInterpreterNameCheck undefinedNamesInCode:(PyCodeObject *)code globals:dict];
+                if ([undefinedNames count] > 0) {
+                        [uncheckedCommand release];
+                        uncheckedCommand = [inputString copy];
+                        Py_DECREF(code);
+                        return [NSString stringWithFormat:@"Undefined name%@: %@\nThe command was not run. Enter it again to run it anyway.\n",
+                                ([undefinedNames count] > 1) ? @"s" : @"",
+                                [undefinedNames componentsJoinedByString:@", "]];
+                }
+        }
+        [uncheckedCommand release];
+        uncheckedCommand = nil;
+        result = PyEval_EvalCode((PyCodeObject *)code, dict, dict);
+        Py_XDECREF(result);
+        Py_DECREF(code);
+exit:
+        PyErr_Print();
+        [[PLInterpreterFileDescriptorCapture sharedCapture] synchronize];
+        return [outputSink drainString];
+}
+
+/**
+ * \brief Run a magic command and return its output.
+ *
+ * \details Magic commands are lines of input starting with the magic prefix.
+ *          They are passed to the run_magic function of the bundled
+ *          liasis_magics module with the globals of __main__, instead of
+ *          being compiled as Python. A long running magic command may display
+ *          its output while it runs, in which case only the rest of its
+ *          output is returned.
+ *
+ * \param inputString The line of input.
+ *
+ * \return The output of the magic command.
+ */
+-(NSString *)runMagicCommand:(NSString *)inputString
+{
+        PyObject * module, * result = NULL;
+        [self setUpInterpreter];
+        [self runStartupFile];
+        [[PLInterpreterDebugger sharedDebugger] setDelegate:self];
+        module = PyImport_ImportModule(PLInterpreterControllerMagicModuleName);
+        PLInterpreterControllerRunningMagicController = self;
+        if (module != NULL)
+                result = PyObject_CallMethod(module, "run_magic", "sO", [inputString UTF8String], PyModule_GetDict(pyMainModule));
+        PLInterpreterControllerRunningMagicController = nil;
+        if (result == NULL)
+                PyErr_Print();
+        Py_XDECREF(result);
+        Py_XDECREF(module);
+        [[PLInterpreterFileDescriptorCapture sharedCapture] synchronize];
+        return [outputSink drainString];
+}
+
+/**
+ * \brief Replace the $name and ${name} references of a shell command with the
+ *        values of the globals of __main__.
+ *
+ * \details Names that are not globals are kept, so that the shell expands
+ *          its own variables, such as $HOME. $$ is replaced by a single $.
+ *
+ * \param commandString The shell command.
+ *
+ * \return The shell command with the globals interpolated.
+ */
+-(NSString *)expandShellCommand:(NSString *)commandString
+{
+        static NSRegularExpression * reference = nil;
+        NSMutableString * expanded = [NSMutableString string];
+        PyObject * globals = PyModule_GetDict(pyMainModule);
+        PyObject * value, * string;
+        NSString * name, * replacement;
+        NSUInteger location = 0;
+        NSRange nameRange;
+        
+        if (reference == nil)
+                reference = [[NSRegularExpression alloc] initWithPattern:@"\\$\\$|\\$\\{([A-Za-z_][A-Za-z0-9_]*)\\}|\\$([A-Za-z_][A-Za-z0-9_]*)"
+                                                                 options:0
+                                                                   error:NULL];
+        for (NSTextCheckingResult * match in [reference matchesInString:commandString options:0 range:NSMakeRange(0, [commandString length])]) {
+                [expanded appendString:[commandString substringWithRange:NSMakeRange(location, [match range].location - location)]];
+                location = NSMaxRange([match range]);
+                nameRange = ([match rangeAtIndex:1].location != NSNotFound) ? [match rangeAtIndex:1] : [match rangeAtIndex:2];
+                if (nameRange.location == NSNotFound) {
+                        [expanded appendString:@"$"];
+                        continue;
+                }
+                name = [commandString substringWithRange:nameRange];
+                replacement = nil;
+                value = PyDict_GetItemString(globals, [name UTF8String]);
+                string = (value != NULL) ? PyObject_Str(value) : NULL;
+                if (string != NULL)
+                        replacement = [NSString stringWithUTF8String:PyString_AsString(string)];
+                Py_XDECREF(string);
+                PyErr_Clear();
+                [expanded appendString:(replacement != nil) ? replacement : [commandString substringWithRange:[match range]]];
+        }
+        [expanded appendString:[commandString substringFromIndex:location]];
+        return expanded;
+}
+
+/**
+ * \brief Return whether or not an event is the interrupt key: control-C,
+ *        command-period or escape.
+ *
+ * \param event The key down event.
+ *
+ * \return YES if the event interrupts the running command.
+ */
+-(BOOL)isInterruptEvent:(NSEvent *)event
+{
+        NSString * characters = [event charactersIgnoringModifiers];
+        NSUInteger modifiers = [event modifierFlags];
+        if ([characters length] != 1)
+                return NO;
+        switch ([characters characterAtIndex:0]) {
+                case 'c':
+                        return (modifiers & NSControlKeyMask) != 0;
+                case '.':
+                        return (modifiers & NSCommandKeyMask) != 0;
+                case 0x1b:
+                        return YES;
+                default:
+                        return NO;
+        }
+}
+
+/**
+ * \brief Write the output of a shell command read so far to the end of the
+ *        interpreter view.
+ *
+ * \details A character split between two reads is kept until the rest of it
+ *          is read, unless the command has finished.
+ *
+ * \param bytes The bytes read and not yet written, from which the written
+ *              bytes are removed.
+ *
+ * \param output The output of the command, to which the written text is
+ *               appended.
+ *
+ * \param finished Whether or not the command has finished.
+ */
+-(void)writeShellOutput:(NSMutableData *)bytes toOutput:(NSMutableString *)output finished:(BOOL)finished
+{
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        NSUInteger length = [bytes length];
+        NSString * text;
+        if (finished == NO)
+                length = PLInterpreterControllerCompleteUTF8Length([bytes bytes], length);
+        if (length == 0)
+                return;
+        text = [[NSString alloc] initWithBytes:[bytes bytes] length:length encoding:NSUTF8StringEncoding];
+        if (text == nil)
+                text = [[NSString alloc] initWithBytes:[bytes bytes] length:length encoding:NSISOLatin1StringEncoding];
+        [bytes replaceBytesInRange:NSMakeRange(0, length) withBytes:NULL length:0];
+        [output appendString:text];
+        [outputParser writeString:text
+                       attributes:[self outputAttributes]
+                    toTextStorage:textStorage
+                          atIndex:[textStorage length]];
+        [text release];
+}
+
+/**
+ * \brief Run a shell command and stream its output into the interpreter
+ *        view.
+ *
+ * \details The command is interpolated with the globals of __main__ and run by
+ *          the shell, spawned with posix_spawn in its own process group with
+ *          stdout and stderr on a pipe. The pipe is read in bulk into a buffer
+ *          private to the command, and the output is written at the end of the
+ *          view at most every display interval while the command runs, so that
+ *          long running commands show their progress. The output does not go
+ *          through the output sink, where the display of background output
+ *          could insert it above the command. The interrupt key sends
+ *          SIGINT to the process group of the command.
+ *
+ * \param commandString The shell command, without the shell prefix.
+ *
+ * \return The whole output of the command, already written to the view.
+ */
+-(NSString *)runShellCommand:(NSString *)commandString
 {
-        [self setPromptAtEnd:PLInterpreterControllerPromptString];
+        NSMutableString * output = [NSMutableString string];
+        NSMutableData * pendingBytes = [NSMutableData data];
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        posix_spawn_file_actions_t fileActions;
+        posix_spawnattr_t attributes;
+        struct pollfd pollDescriptor;
+        NSString * drained, * errorMessage;
+        NSEvent * event;
+        const char * command;
+        char * arguments[4];
+        char * buffer = NULL;
+        int pipeDescriptors[2], status, errorNumber;
+        uint64_t lastDisplay;
+        ssize_t count;
+        pid_t pid;
+        
+        [self setUpInterpreter];
+        command = [[self expandShellCommand:commandString] UTF8String];
+        if (pipe(pipeDescriptors) != 0) {
+                errorNumber = errno;
+                goto error;
+        }
+        posix_spawn_file_actions_init(&fileActions);
+        posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        posix_spawn_file_actions_adddup2(&fileActions, pipeDescriptors[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&fileActions, pipeDescriptors[1], STDERR_FILENO);
+        posix_spawn_file_actions_addclose(&fileActions, pipeDescriptors[0]);
+        posix_spawn_file_actions_addclose(&fileActions, pipeDescriptors[1]);
+        posix_spawnattr_init(&attributes);
+        posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attributes, 0);
+        arguments[0] = "sh";
+        arguments[1] = "-c";
+        arguments[2] = (char *)command;
+        arguments[3] = NULL;
+        errorNumber = posix_spawn(&pid, PLInterpreterControllerShellPath, &fileActions, &attributes, arguments, environ);
+        posix_spawn_file_actions_destroy(&fileActions);
+        posix_spawnattr_destroy(&attributes);
+        close(pipeDescriptors[1]);
+        if (errorNumber != 0) {
+                close(pipeDescriptors[0]);
+                goto error;
+        }
+        buffer = malloc(PLInterpreterControllerShellReadSize);
+        pollDescriptor.fd = pipeDescriptors[0];
+        pollDescriptor.events = POLLIN;
+        lastDisplay = mach_absolute_time();
+        while (pollDescriptor.fd >= 0) {
+                if (poll(&pollDescriptor, 1, PLInterpreterControllerShellDisplayInterval) > 0) {
+                        count = read(pollDescriptor.fd, buffer, PLInterpreterControllerShellReadSize);
+                        if (count > 0) {
+                                [pendingBytes appendBytes:buffer length:(NSUInteger)count];
+                        } else if (count == 0 || errno != EINTR) {
+                                close(pollDescriptor.fd);
+                                pollDescriptor.fd = -1;
+                        }
+                }
+                if (PLInterpreterMillisecondsSince(lastDisplay) < PLInterpreterControllerShellDisplayInterval)
+                        continue;
+                lastDisplay = mach_absolute_time();
+                while ((event = [NSApp nextEventMatchingMask:NSKeyDownMask
+                                                   untilDate:nil
+                                                      inMode:NSDefaultRunLoopMode
+                                                     dequeue:YES]) != nil) {
+                        if ([self isInterruptEvent:event])
+                                killpg(pid, SIGINT);
+                }
+                if ([pendingBytes length] > 0) {
+                        [self writeShellOutput:pendingBytes toOutput:output finished:NO];
+                        [interpreterView scrollToEndOfDocument:self];
+                        [interpreterView displayIfNeeded];
+                }
+        }
+        free(buffer);
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+                ;
+        goto exit;
+error:
+        errorMessage = [NSString stringWithFormat:@"%s: %s\n", PLInterpreterControllerShellPath, strerror(errorNumber)];
+        [pendingBytes appendBytes:[errorMessage UTF8String] length:strlen([errorMessage UTF8String])];
+exit:
+        [self writeShellOutput:pendingBytes toOutput:output finished:YES];
+        [[PLInterpreterFileDescriptorCapture sharedCapture] synchronize];
+        drained = [outputSink drainString];
+        [output appendString:drained];
+        [outputParser writeString:drained
+                       attributes:[self outputAttributes]
+                    toTextStorage:textStorage
+                          atIndex:[textStorage length]];
+        return output;
 }
 
-#pragma mark Process Interpreter Input
-
 /**
- * \brief Execute statement in the python interpreter and return output string.
- *
- * \details This method accepts an NSString as input and passes it to the python
- *          interpreter as a UTF8 string. Using the internally defined and
- *          created pythonobject to catch stdout and stderr, this method
- *          retrieves the python output and returns it as an NSString. If an
- *          executed statement displays no output in the interpreter, this
- *          method returns an empty string. As stdout is appended with each
- *          output, this method only returns the newly added segment.
+ * \brief Display the output of the running magic command at the end of the
+ *        interpreter view and check for the interrupt key.
  *
- * \param inputString The string passed to the interpreter.
+ * \details The first call ends the input line of the command. The output
+ *          drained from the sink is kept, so that the transcript records it
+ *          with the rest of the output of the command.
  *
- * \return The output from running the command in the interpreter.
+ * \return YES if the interrupt key was pressed.
  */
--(NSString *)runPythonCommand:(NSString *)inputString
+-(BOOL)displayProgress
 {
-        if ([inputString isEqualToString:@""])
-                return @"";
-        NSUInteger beforeLength = [[NSString stringWithUTF8String:PyString_AsString(PyObject_GetAttrString(pyOutputCatcher, "value"))] length];
-        PyObject * dict = PyModule_GetDict(pyMainModule);
-        PyRun_String([inputString UTF8String], Py_single_input, dict, dict);
-        PyErr_Print();
-        PyObject * pyOutput = PyObject_GetAttrString(pyOutputCatcher, "value");  // get the stdout and stderr from catchOutErr object
-        NSString * output = [NSString stringWithUTF8String:PyString_AsString(pyOutput)];
-        Py_DECREF(pyOutput);
-        if ([output length] == beforeLength)
-                return @"";
-        else
-                return [output substringWithRange:NSMakeRange(beforeLength, [output length] - beforeLength)];
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        NSAttributedString * newline;
+        NSString * drained;
+        NSEvent * event;
+        BOOL interrupted = NO;
+        while ((event = [NSApp nextEventMatchingMask:NSKeyDownMask
+                                           untilDate:nil
+                                              inMode:NSDefaultRunLoopMode
+                                             dequeue:YES]) != nil) {
+                if ([self isInterruptEvent:event])
+                        interrupted = YES;
+        }
+        if (![outputSink hasPendingOutput])
+                return interrupted;
+        if (progressOutput == nil) {
+                progressOutput = [[NSMutableString alloc] init];
+                progressInputEndLocation = [textStorage length];
+                newline = [[NSAttributedString alloc] initWithString:@"\n" attributes:[self outputAttributes]];
+                [textStorage appendAttributedString:newline];
+                [newline release];
+        }
+        drained = [outputSink drainString];
+        [progressOutput appendString:drained];
+        [outputParser writeString:drained
+                       attributes:[self outputAttributes]
+                    toTextStorage:textStorage
+                          atIndex:[textStorage length]];
+        [interpreterView scrollToEndOfDocument:self];
+        [interpreterView displayIfNeeded];
+        return interrupted;
+}
+
++(BOOL)displayProgressOfRunningCommand
+{
+        return [PLInterpreterControllerRunningMagicController displayProgress];
 }
 
 /**
@@ -169,22 +1254,88 @@ NSString * const PLInterpreterControllerContinuationPromptString = @"... ";
  *          includes a line continuation feature (semicolon or backlash, the
  *          statement is stored to the multilineInputString instance variable.
  *          This multiline string is evaluated after the user enters a blank
- *          string. Add user input to the history of the interpreter.
+ *          string. Lines starting with the magic prefix are run as magic
+ *          commands, lines starting with the shell prefix are run by the shell
+ *          with their output streamed into the view, and a name followed by ?
+ *          or ?? is inspected in a popover instead of being run. While a
+ *          debugged command is paused, the input is a debugger command. The
+ *          watch expressions are evaluated after each command. Add user input
+ *          to the history of the interpreter. The output is written through the
+ *          output parser, which interprets escape sequences and carriage
+ *          returns.
  */
 -(void)processNewline
 {
         NSAttributedString * attrString;
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        PLInterpreterTranscriptCommand command;
+        NSUInteger inputEndLocation = 0;
+        BOOL outputWritten = NO;
+        NSString * commandString = nil;
+        PLInterpreterInspection * inspection = nil;
         NSString * promptString = PLInterpreterControllerPromptString;
         NSString * inputString = [[interpreterView string] substringFromIndex:promptLocation];
-        NSMutableString * outputString = [[NSMutableString alloc] initWithString:@"\n"];
+        NSMutableString * outputString;
+        if (debugFrame != NULL) {
+                [self processDebugCommand:inputString];
+                return;
+        }
+        outputString = [[NSMutableString alloc] initWithString:@""];
+        PLInterpreterControllerBackgroundOutputController = self;
+        [commandNames release];
+        commandNames = nil;
         if ([inputString isEqualToString:@""]) {
                 if ([multilineInputString isEqualToString:@""] == NO) {
+                        commandString = [[multilineInputString copy] autorelease];
+                        [[PLInterpreterJournal sharedJournal] appendInput:commandString];
                         [outputString appendString:[self runPythonCommand:multilineInputString]];
                         [multilineInputString setString:@""];
                 }
                 goto exit;
         }
         
+        if ([multilineInputString isEqualToString:@""] && [inputString hasPrefix:PLInterpreterControllerMagicPrefix]) {
+                commandString = inputString;
+                [[PLInterpreterJournal sharedJournal] appendInput:commandString];
+                [outputString appendString:[self runMagicCommand:inputString]];
+                [historyObject addEntry:inputString];
+                if (progressOutput != nil) {
+                        inputEndLocation = progressInputEndLocation;
+                        [outputParser writeString:outputString
+                                       attributes:[self outputAttributes]
+                                    toTextStorage:textStorage
+                                          atIndex:[textStorage length]];
+                        [outputString insertString:progressOutput atIndex:0];
+                        [progressOutput release];
+                        progressOutput = nil;
+                        outputWritten = YES;
+                }
+                goto exit;
+        }
+        
+        if ([multilineInputString isEqualToString:@""] && [inputString hasPrefix:PLInterpreterControllerShellPrefix]) {
+                command.promptLocation = commandPromptLocation;
+                inputEndLocation = [textStorage length];
+                attrString = [[NSAttributedString alloc] initWithString:@"\n" attributes:[self outputAttributes]];
+                [textStorage appendAttributedString:attrString];
+                [attrString release];
+                commandString = inputString;
+                [[PLInterpreterJournal sharedJournal] appendInput:commandString];
+                [outputString appendString:[self runShellCommand:[inputString substringFromIndex:[PLInterpreterControllerShellPrefix length]]]];
+                outputWritten = YES;
+                commandNames = [[NSSet alloc] init];
+                [historyObject addEntry:inputString];
+                goto exit;
+        }
+        
+        if ([multilineInputString isEqualToString:@""] && [inputString hasSuffix:@"?"]) {
+                inspection = [self inspectionOfCommand:inputString];
+                if (inspection != nil) {
+                        [historyObject addEntry:inputString];
+                        goto exit;
+                }
+        }
+        
         const char lastInputCharacter = [inputString characterAtIndex:[inputString length] - 1];
         if (lastInputCharacter == ':' || lastInputCharacter == '\\' || [multilineInputString isEqualToString:@""] == NO) {
                 [multilineInputString appendString:[NSString stringWithFormat:@"%@\n", inputString]];
@@ -197,19 +1348,39 @@ NSString * const PLInterpreterControllerContinuationPromptString = @"... ";
                 //        } else {
                 //                NSLog(@"Warning: Interpreter is unresponsive: \"%@\" not sent", inputString);
                 //        }
+                commandString = inputString;
+                [[PLInterpreterJournal sharedJournal] appendInput:commandString];
                 [outputString appendString:[self runPythonCommand:inputString]];
                 [historyObject addEntry:inputString];
         }
         
 exit:
-        attrString = [[NSAttributedString alloc] initWithString:outputString
-                                                     attributes:[NSDictionary dictionaryWithObjectsAndKeys:
-                                                                 [interpreterView font], NSFontAttributeName,
-                                                                 [interpreterView textColor], NSForegroundColorAttributeName,
-                                                                 nil]];
-        [[interpreterView textStorage] appendAttributedString:attrString];
-        [attrString release];
+        command.promptLocation = commandPromptLocation;
+        if (outputWritten == NO) {
+                inputEndLocation = [textStorage length];
+                attrString = [[NSAttributedString alloc] initWithString:@"\n" attributes:[self outputAttributes]];
+                [textStorage appendAttributedString:attrString];
+                [attrString release];
+                [outputParser writeString:outputString
+                               attributes:[self outputAttributes]
+                            toTextStorage:textStorage
+                                  atIndex:[textStorage length]];
+        }
+        command.inputRange = NSMakeRange(command.promptLocation + [PLInterpreterControllerPromptString length],
+                                         inputEndLocation - command.promptLocation - [PLInterpreterControllerPromptString length]);
+        command.outputRange = NSMakeRange(inputEndLocation + 1, [textStorage length] - inputEndLocation - 1);
+        if (commandString != nil) {
+                [transcriptIndex addCommand:command];
+                [[PLInterpreterJournal sharedJournal] appendOutput:outputString];
+        }
         [self setPromptAtEnd:promptString];
+        [signaturePopover close];
+        if (inspection != nil)
+                [self showInspection:inspection atLocation:inputEndLocation - 1];
+        [transcriptSearch updateWithString:[textStorage string]];
+        if (commandString != nil)
+                [self evaluateWatches];
+        [self discardInputUndo];
         [interpreterView setSelectedRange:NSMakeRange(promptLocation, 0)];
         [interpreterView scrollToEndOfDocument:self];
         [outputString release];
@@ -258,6 +1429,14 @@ exit:
                                 shouldEdit = NO;
                                 [self processTab];
                                 break;
+                        case '(':
+                                shouldEdit = YES;
+                                [self requestSignatureBeforeLocation:location];
+                                break;
+                        case ')':
+                                shouldEdit = YES;
+                                [signaturePopover close];
+                                break;
                         default:
                                 shouldEdit = YES;
                                 break;
@@ -287,6 +1466,7 @@ exit:
                 aRange.location = promptLocation;
                 [[interpreterView textStorage] replaceCharactersInRange:aRange
                                                    withAttributedString:emptyString];
+                [self discardInputUndo];
         }
         [emptyString release];
         return shouldEdit;
@@ -344,6 +1524,7 @@ exit:
         const char INSERTION = 1;
         const char DELETION = 2;
         const char REPLACEMENT = 4;
+        [self setUpInterpreter];
         if (affectedCharRange.length == 0) {
                 typeOfEdit = INSERTION;
         } else if ([replacementString length] == 0) {
@@ -386,6 +1567,650 @@ exit:
         return shouldChange;
 }
 
+#pragma mark Transcript Index
+
+/**
+ * \brief Update the transcript index after the text storage is edited.
+ *
+ * \param notification The NSTextStorageDidProcessEditingNotification of the
+ *                     interpreter view text storage.
+ */
+-(void)textStorageDidProcessEditing:(NSNotification *)notification
+{
+        NSTextStorage * textStorage = [notification object];
+        if (([textStorage editedMask] & NSTextStorageEditedCharacters) == 0)
+                return;
+        [transcriptIndex didEditRange:[textStorage editedRange]
+                       changeInLength:[textStorage changeInLength]
+                               string:[textStorage string]];
+        [transcriptSearch didEditRange:[textStorage editedRange]];
+        if ([searchMatches count] > 0 && [textStorage editedRange].location < NSMaxRange([[searchMatches lastObject] rangeValue]))
+                [self clearSearchMatches];
+}
+
+/**
+ * \brief Select the input of a command and scroll to it.
+ *
+ * \param commandIndex The index of the command in the transcript index.
+ */
+-(void)selectCommandAtIndex:(NSUInteger)commandIndex
+{
+        NSRange inputRange = [transcriptIndex commandAtIndex:commandIndex].inputRange;
+        [interpreterView setSelectedRange:inputRange];
+        [interpreterView scrollRangeToVisible:inputRange];
+}
+
+-(IBAction)selectPreviousCommand:(id)sender
+{
+        NSUInteger location = [interpreterView selectedRange].location;
+        NSUInteger commandIndex = [transcriptIndex commandIndexForCharacterIndex:location];
+        if (commandIndex == NSNotFound)
+                return;
+        if (commandIndex > 0 && [transcriptIndex commandAtIndex:commandIndex].inputRange.location >= location)
+                commandIndex--;
+        [self selectCommandAtIndex:commandIndex];
+}
+
+-(IBAction)selectNextCommand:(id)sender
+{
+        NSUInteger location = [interpreterView selectedRange].location;
+        NSUInteger commandIndex = [transcriptIndex commandIndexForCharacterIndex:location];
+        commandIndex = (commandIndex == NSNotFound) ? 0 : commandIndex + 1;
+        if (commandIndex < [transcriptIndex commandCount]) {
+                [self selectCommandAtIndex:commandIndex];
+        } else {
+                [interpreterView setSelectedRange:NSMakeRange([[interpreterView string] length], 0)];
+                [interpreterView scrollToEndOfDocument:self];
+        }
+}
+
+#pragma mark Transcript Search
+
+/**
+ * \brief Remove the highlighting of the search matches and forget the last
+ *        search.
+ */
+-(void)clearSearchMatches
+{
+        NSLayoutManager * layoutManager = [interpreterView layoutManager];
+        NSUInteger length = [[interpreterView string] length];
+        NSRange range;
+        for (NSValue * match in searchMatches) {
+                range = NSIntersectionRange([match rangeValue], NSMakeRange(0, length));
+                [layoutManager removeTemporaryAttribute:NSBackgroundColorAttributeName forCharacterRange:range];
+        }
+        [searchMatches removeAllObjects];
+        [searchString release];
+        searchString = nil;
+        [transcriptSearch cancelSearch];
+}
+
+/**
+ * \brief Highlight a batch of search matches, selecting the first match of
+ *        the search.
+ *
+ * \param matches The ranges of the matches as NSValue objects.
+ */
+-(void)addSearchMatches:(NSArray *)matches
+{
+        NSLayoutManager * layoutManager = [interpreterView layoutManager];
+        NSUInteger length = [[interpreterView string] length];
+        BOOL selectFirst = ([searchMatches count] == 0);
+        NSRange range;
+        for (NSValue * match in matches) {
+                range = [match rangeValue];
+                if (NSMaxRange(range) > length)
+                        break;
+                [layoutManager addTemporaryAttribute:NSBackgroundColorAttributeName
+                                               value:[NSColor yellowColor]
+                                   forCharacterRange:range];
+                [searchMatches addObject:match];
+        }
+        if (selectFirst && [searchMatches count] > 0)
+                [self selectSearchMatch:[[searchMatches objectAtIndex:0] rangeValue]];
+}
+
+/**
+ * \brief Select a search match and scroll to it.
+ *
+ * \param range The range of the match.
+ */
+-(void)selectSearchMatch:(NSRange)range
+{
+        [interpreterView setSelectedRange:range];
+        [interpreterView scrollRangeToVisible:range];
+        [interpreterView showFindIndicatorForRange:range];
+}
+
+/**
+ * \brief Select the first search match after the selection, wrapping around
+ *        to the first match.
+ */
+-(void)selectNextSearchMatch
+{
+        NSUInteger location = [interpreterView selectedRange].location;
+        NSUInteger low = 0, high = [searchMatches count], middle;
+        while (low < high) {
+                middle = low + (high - low)/2;
+                if ([[searchMatches objectAtIndex:middle] rangeValue].location <= location)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        if (low == [searchMatches count])
+                low = 0;
+        [self selectSearchMatch:[[searchMatches objectAtIndex:low] rangeValue]];
+}
+
+-(IBAction)searchTranscript:(id)sender
+{
+        NSString * string = [sender stringValue];
+        if ([string isEqualToString:searchString] && [searchMatches count] > 0) {
+                [self selectNextSearchMatch];
+                return;
+        }
+        [self clearSearchMatches];
+        if ([string length] == 0)
+                return;
+        searchString = [string copy];
+        [transcriptSearch updateWithString:[interpreterView string]];
+        [transcriptSearch searchForString:string resultHandler:^(NSArray * matches, BOOL finished) {
+                [self addSearchMatches:matches];
+        }];
+}
+
+#pragma mark Folded Lines
+
+/**
+ * \brief Expand or copy a folded line when its placeholder is clicked.
+ *
+ * \details Clicking the marker of a folded line placeholder replaces the
+ *          placeholder with the full line. Option-clicking copies the full line
+ *          to the general pasteboard without expanding it.
+ *
+ * \param textView The text view where the link was clicked.
+ *
+ * \param link The link object, a PLInterpreterFoldedText for folded lines.
+ *
+ * \param charIndex The index of the clicked character.
+ *
+ * \return YES if the link was handled, otherwise NO.
+ */
+-(BOOL)textView:(NSTextView *)textView clickedOnLink:(id)link atIndex:(NSUInteger)charIndex
+{
+        NSPasteboard * pasteboard;
+        BOOL handled = NO;
+        if (![link isKindOfClass:[PLInterpreterFoldedText class]])
+                goto exit;
+        handled = YES;
+        if ([[NSApp currentEvent] modifierFlags] & NSAlternateKeyMask) {
+                pasteboard = [NSPasteboard generalPasteboard];
+                [pasteboard clearContents];
+                [pasteboard setString:[link text] forType:NSPasteboardTypeString];
+        } else {
+                [self expandFoldedLineAtIndex:charIndex];
+        }
+exit:
+        return handled;
+}
+
+/**
+ * \brief Replace the placeholder of a folded line with the full line.
+ *
+ * \details The prompt locations are moved by the difference in length if the
+ *          placeholder is before the prompt.
+ *
+ * \param charIndex The index of a character of the placeholder.
+ */
+-(void)expandFoldedLineAtIndex:(NSUInteger)charIndex
+{
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        PLInterpreterFoldedText * foldedText;
+        NSAttributedString * line;
+        NSRange placeholderRange;
+        NSInteger offset;
+        foldedText = [textStorage attribute:PLInterpreterFoldedTextAttributeName
+                                    atIndex:charIndex
+                      longestEffectiveRange:&placeholderRange
+                                    inRange:NSMakeRange(0, [textStorage length])];
+        if (foldedText == nil)
+                return;
+        [foldedText setOpen:NO];
+        line = [[NSAttributedString alloc] initWithString:[foldedText text] attributes:[self outputAttributes]];
+        offset = (NSInteger)[line length] - (NSInteger)placeholderRange.length;
+        [textStorage replaceCharactersInRange:placeholderRange withAttributedString:line];
+        [line release];
+        if (placeholderRange.location < promptStartLocation) {
+                promptStartLocation += offset;
+                promptLocation += offset;
+                [self discardInputUndo];
+        }
+        if (placeholderRange.location < commandPromptLocation)
+                commandPromptLocation += offset;
+}
+
+#pragma mark Signature Hints
+
+/**
+ * \brief Look up the signature of the callable named before an opening
+ *        parenthesis.
+ *
+ * \details The dotted name before the parenthesis is resolved statically by
+ *          the bundled liasis_introspection module on the completion queue,
+ *          which caches the signature of each callable. The keystroke is not
+ *          delayed, and the signature is shown when the lookup finishes,
+ *          unless another parenthesis was typed or the input was entered.
+ *
+ * \param location The location of the opening parenthesis.
+ */
+-(void)requestSignatureBeforeLocation:(NSUInteger)location
+{
+        static NSRegularExpression * dottedName = nil;
+        NSString * input = [[interpreterView string] substringWithRange:NSMakeRange(promptLocation, location - promptLocation)];
+        NSTextCheckingResult * match;
+        NSString * expression;
+        PyObject * globals;
+        NSUInteger request;
+        
+        if (dottedName == nil)
+                dottedName = [[NSRegularExpression alloc] initWithPattern:@"[A-Za-z_][A-Za-z0-9_]*(\\.[A-Za-z_][A-Za-z0-9_]*)*$"
+                                                                  options:0
+                                                                    error:NULL];
+        match = [dottedName firstMatchInString:input options:0 range:NSMakeRange(0, [input length])];
+        if (match == nil)
+                return;
+        expression = [input substringWithRange:[match range]];
+        [self setUpInterpreter];
+        request = ++signatureRequest;
+        globals = PyModule_GetDict(pyMainModule);
+        dispatch_async(PLInterpreterControllerCompletionQueue(), ^{
+                PyGILState_STATE state = PyGILState_Ensure();
+                PyObject * module = PyImport_ImportModule(PLInterpreterControllerIntrospectionModuleName);
+                PyObject * result = NULL;
+                NSString * signature = nil;
+                if (module != NULL)
+                        result = PyObject_CallMethod(module, "signature", "sO", [expression UTF8String], globals);
+                if (result != NULL && PyString_Check(result))
+                        signature = [[NSString alloc] initWithUTF8String:PyString_AS_STRING(result)];
+                if (result == NULL)
+                        PyErr_Clear();
+                Py_XDECREF(result);
+                Py_XDECREF(module);
+                PyGILState_Release(state);
+                dispatch_async(dispatch_get_main_queue(), ^{
+                        if (signature != nil && request == signatureRequest && [[interpreterView string] length] > location)
+                                [self showSignature:signature atLocation:location];
+                        [signature release];
+                });
+        });
+}
+
+/**
+ * \brief Show a signature in a popover below the opening parenthesis.
+ *
+ * \param signature The signature.
+ *
+ * \param location The location of the opening parenthesis.
+ */
+-(void)showSignature:(NSString *)signature atLocation:(NSUInteger)location
+{
+        NSLayoutManager * layoutManager = [interpreterView layoutManager];
+        NSViewController * contentController;
+        NSTextField * label;
+        NSRect rect;
+        
+        if (signaturePopover == nil) {
+                label = [[[NSTextField alloc] initWithFrame:NSZeroRect] autorelease];
+                [label setEditable:NO];
+                [label setSelectable:NO];
+                [label setBordered:NO];
+                [label setDrawsBackground:NO];
+                [label setFont:[interpreterView font]];
+                contentController = [[[NSViewController alloc] init] autorelease];
+                [contentController setView:label];
+                signaturePopover = [[NSPopover alloc] init];
+                [signaturePopover setBehavior:NSPopoverBehaviorTransient];
+                [signaturePopover setAnimates:NO];
+                [signaturePopover setContentViewController:contentController];
+        }
+        label = (NSTextField *)[[signaturePopover contentViewController] view];
+        [label setStringValue:signature];
+        [label sizeToFit];
+        [label setFrameSize:NSMakeSize(NSWidth([label frame]) + 8, NSHeight([label frame]) + 4)];
+        [signaturePopover setContentSize:[label frame].size];
+        rect = [layoutManager boundingRectForGlyphRange:[layoutManager glyphRangeForCharacterRange:NSMakeRange(location, 1)
+                                                                               actualCharacterRange:NULL]
+                                        inTextContainer:[interpreterView textContainer]];
+        rect = NSOffsetRect(rect, [interpreterView textContainerOrigin].x, [interpreterView textContainerOrigin].y);
+        [signaturePopover showRelativeToRect:rect ofView:interpreterView preferredEdge:NSMaxYEdge];
+}
+
+#pragma mark Watch Expressions
+
+/**
+ * \brief Return the controller of the watch panel, creating it when first
+ *        needed.
+ *
+ * \return The PLInterpreterWatchPanelController object.
+ */
+-(PLInterpreterWatchPanelController *)watchPanelController
+{
+        if (watchPanelController == nil)
+                watchPanelController = [[PLInterpreterWatchPanelController alloc] initWithWatchList:[PLInterpreterWatchList sharedWatchList]];
+        return watchPanelController;
+}
+
+/**
+ * \brief Evaluate the watch expressions affected by the last command and
+ *        display their values in the watch panel.
+ *
+ * \details Only expressions reading a name that was rebound, or that was used
+ *          by the last command, are evaluated, each within the time budget in
+ *          the user defaults.
+ */
+-(void)evaluateWatches
+{
+        PLInterpreterWatchList * watchList = [PLInterpreterWatchList sharedWatchList];
+        NSInteger budget = [[NSUserDefaults standardUserDefaults] integerForKey:PLInterpreterControllerWatchBudgetKey];
+        if ([[watchList watches] count] == 0 || interpreterSetUp == NO)
+                return;
+        if (budget <= 0)
+                budget = PLInterpreterControllerDefaultWatchBudget;
+        if ([watchList evaluateWithGlobals:PyModule_GetDict(pyMainModule) commandNames:commandNames budget:budget/1000.0])
+                [[self watchPanelController] reloadData];
+}
+
+/**
+ * \brief Display the watch expressions after one is added or removed, and
+ *        show the watch panel beside the interpreter when there are any.
+ *
+ * \param notification The PLInterpreterWatchListDidChangeNotification.
+ */
+-(void)watchListDidChange:(NSNotification *)notification
+{
+        if (PLInterpreterControllerBackgroundOutputController != self)
+                return;
+        [[self watchPanelController] reloadData];
+        if ([[[notification object] watches] count] > 0)
+                [[self watchPanelController] showBesideWindow:[interpreterView window]];
+        else
+                [[self watchPanelController] close];
+}
+
+#pragma mark Debugger
+
+/**
+ * \brief Write output at the end of the interpreter view, starting on a new
+ *        line.
+ *
+ * \param output The output.
+ */
+-(void)writeDebugOutput:(NSString *)output
+{
+        NSTextStorage * textStorage = [interpreterView textStorage];
+        NSString * string = [textStorage string];
+        if ([string length] > 0 && [string characterAtIndex:[string length] - 1] != '\n')
+                output = [@"\n" stringByAppendingString:output];
+        [outputParser writeString:output
+                       attributes:[self outputAttributes]
+                    toTextStorage:textStorage
+                          atIndex:[textStorage length]];
+}
+
+/**
+ * \brief Return the location and the current source line of a frame.
+ *
+ * \param frame The frame.
+ *
+ * \return The description of the frame, ending with a newline.
+ */
+-(NSString *)descriptionOfFrame:(PyFrameObject *)frame
+{
+        int line = PyFrame_GetLineNumber(frame);
+        PyObject * module = PyImport_ImportModule("linecache");
+        PyObject * source = NULL;
+        NSString * description;
+        if (module != NULL)
+                source = PyObject_CallMethod(module, "getline", "Oi", frame->f_code->co_filename, line);
+        description = [NSString stringWithFormat:@"> %s(%d)%s()\n-> %s\n",
+                       PyString_AsString(frame->f_code->co_filename),
+                       line,
+                       PyString_AsString(frame->f_code->co_name),
+                       (source != NULL && PyString_Check(source)) ? PyString_AS_STRING(source) : ""];
+        Py_XDECREF(source);
+        Py_XDECREF(module);
+        PyErr_Clear();
+        return [description stringByReplacingOccurrencesOfString:@"\n\n" withString:@"\n"];
+}
+
+/**
+ * \brief Pause a debugged command and handle debugger commands typed in the
+ *        interpreter view until it resumes.
+ *
+ * \details The output of the command so far and the paused location are
+ *          written to the view, followed by the debug prompt. Events are
+ *          handled in a nested loop on the main thread, which is running the
+ *          command, until a debugger command resumes it. The global
+ *          interpreter lock is released while the loop waits, as it is while
+ *          the interpreter is idle.
+ *
+ * \param debugger The debugger.
+ *
+ * \param frame The paused frame.
+ *
+ * \return How the command resumes.
+ */
+-(PLInterpreterDebuggerAction)debugger:(PLInterpreterDebugger *)debugger didPauseInFrame:(PyFrameObject *)frame
+{
+        NSEvent * event;
+        [[PLInterpreterFileDescriptorCapture sharedCapture] synchronize];
+        [self writeDebugOutput:[[outputSink drainString] stringByAppendingString:[self descriptionOfFrame:frame]]];
+        [self setPromptAtEnd:PLInterpreterControllerDebugPromptString];
+        [self discardInputUndo];
+        [interpreterView setSelectedRange:NSMakeRange(promptLocation, 0)];
+        [interpreterView scrollToEndOfDocument:self];
+        debugFrame = frame;
+        debugAction = PLInterpreterDebuggerQuit;
+        while (debugFrame != NULL) {
+                event = [NSApp nextEventMatchingMask:NSAnyEventMask
+                                           untilDate:[NSDate distantFuture]
+                                              inMode:NSDefaultRunLoopMode
+                                             dequeue:YES];
+                if (event != nil)
+                        [NSApp sendEvent:event];
+        }
+        return debugAction;
+}
+
+/**
+ * \brief Run a statement in the paused frame and return its output.
+ *
+ * \param statement The statement.
+ *
+ * \return The output of the statement.
+ */
+-(NSString *)runStatementInDebugFrame:(NSString *)statement
+{
+        PyObject * result;
+        PyFrame_FastToLocals(debugFrame);
+        result = PyRun_String([statement UTF8String], Py_single_input, debugFrame->f_globals, debugFrame->f_locals);
+        PyFrame_LocalsToFast(debugFrame, 0);
+        if (result == NULL)
+                PyErr_Print();
+        Py_XDECREF(result);
+        [[PLInterpreterFileDescriptorCapture sharedCapture] synchronize];
+        return [outputSink drainString];
+}
+
+/**
+ * \brief Handle a line of input entered while a debugged command is paused.
+ *
+ * \details c or continue, s or step, n or next, and q or quit resume the
+ *          command. w or where shows the stack of the paused frame. Any other
+ *          input is a statement run in the paused frame, and p expression
+ *          displays an expression.
+ *
+ * \param inputString The line of input.
+ */
+-(void)processDebugCommand:(NSString *)inputString
+{
+        NSString * command = [inputString stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        NSMutableString * output = [NSMutableString string];
+        PyFrameObject * frame;
+        if ([command length] > 0)
+                [historyObject addEntry:inputString];
+        if ([command isEqualToString:@"c"] || [command isEqualToString:@"continue"])
+                debugAction = PLInterpreterDebuggerContinue;
+        else if ([command isEqualToString:@"s"] || [command isEqualToString:@"step"])
+                debugAction = PLInterpreterDebuggerStep;
+        else if ([command isEqualToString:@"n"] || [command isEqualToString:@"next"])
+                debugAction = PLInterpreterDebuggerNext;
+        else if ([command isEqualToString:@"q"] || [command isEqualToString:@"quit"])
+                debugAction = PLInterpreterDebuggerQuit;
+        else
+                goto run;
+        debugFrame = NULL;
+        return;
+run:
+        if ([command isEqualToString:@"w"] || [command isEqualToString:@"where"]) {
+                for (frame = debugFrame; frame != NULL; frame = frame->f_back)
+                        [output insertString:[self descriptionOfFrame:frame] atIndex:0];
+        } else if ([command hasPrefix:@"p "]) {
+                [output appendString:[self runStatementInDebugFrame:[command substringFromIndex:2]]];
+        } else if ([command length] > 0) {
+                [output appendString:[self runStatementInDebugFrame:command]];
+        }
+        [self writeDebugOutput:output];
+        [self setPromptAtEnd:PLInterpreterControllerDebugPromptString];
+        [self discardInputUndo];
+        [interpreterView setSelectedRange:NSMakeRange(promptLocation, 0)];
+        [interpreterView scrollToEndOfDocument:self];
+}
+
+#pragma mark Object Inspection
+
+/**
+ * \brief Return the inspection requested by an inspection command.
+ *
+ * \details The name is resolved statically by the inspection function of the
+ *          bundled liasis_introspection module, which returns the documentation
+ *          of the object for ?, or the location of its source for ??. The lines
+ *          of functions and methods are found from their code objects without
+ *          reading the source, while classes are located by inspect, which
+ *          reads the file. The source itself is mapped and read a page at a
+ *          time by the inspection as it is displayed. Inspections are cached by
+ *          file lines or documentation, so that inspecting the same object
+ *          again keeps the pages already scanned. An object that cannot be
+ *          resolved, or input that is not an inspection command, returns nil
+ *          and is run as Python instead.
+ *
+ * \param inputString The line of input.
+ *
+ * \return The inspection, or nil.
+ */
+-(PLInterpreterInspection *)inspectionOfCommand:(NSString *)inputString
+{
+        static NSRegularExpression * inspectionCommand = nil;
+        PLInterpreterInspection * inspection = nil;
+        NSTextCheckingResult * match;
+        PyObject * module, * result = NULL;
+        NSString * expression, * kind, * title, * text, * key;
+        long firstLine = 1, lineCount = 0;
+        BOOL source, isFile;
+        Py_ssize_t i;
+        
+        if (inspectionCommand == nil)
+                inspectionCommand = [[NSRegularExpression alloc] initWithPattern:PLInterpreterControllerInspectionPattern
+                                                                         options:0
+                                                                           error:NULL];
+        match = [inspectionCommand firstMatchInString:inputString options:0 range:NSMakeRange(0, [inputString length])];
+        if (match == nil)
+                return nil;
+        expression = [inputString substringWithRange:[match rangeAtIndex:1]];
+        source = ([match rangeAtIndex:3].length == 2);
+        [self setUpInterpreter];
+        [self runStartupFile];
+        module = PyImport_ImportModule(PLInterpreterControllerIntrospectionModuleName);
+        if (module != NULL)
+                result = PyObject_CallMethod(module, "inspection", "sOi", [expression UTF8String], PyModule_GetDict(pyMainModule), (int)source);
+        if (result == NULL)
+                PyErr_Clear();
+        if (result == NULL || PyTuple_Check(result) == NO || PyTuple_GET_SIZE(result) < 3)
+                goto exit;
+        for (i = 0; i < 3; i++)
+                if (PyString_Check(PyTuple_GET_ITEM(result, i)) == NO)
+                        goto exit;
+        kind = [NSString stringWithUTF8String:PyString_AS_STRING(PyTuple_GET_ITEM(result, 0))];
+        title = [NSString stringWithUTF8String:PyString_AS_STRING(PyTuple_GET_ITEM(result, 1))];
+        text = [NSString stringWithUTF8String:PyString_AS_STRING(PyTuple_GET_ITEM(result, 2))];
+        isFile = ([kind isEqualToString:@"file"] && PyTuple_GET_SIZE(result) == 5);
+        if (text == nil || title == nil)
+                goto exit;
+        if (isFile) {
+                firstLine = PyInt_AsLong(PyTuple_GET_ITEM(result, 3));
+                lineCount = PyInt_AsLong(PyTuple_GET_ITEM(result, 4));
+                key = [NSString stringWithFormat:@"%@:%ld:%ld", text, firstLine, lineCount];
+        }
+        else
+                key = text;
+        if (inspectionCache == nil) {
+                inspectionCache = [[NSCache alloc] init];
+                [inspectionCache setCountLimit:PLInterpreterControllerInspectionCacheCount];
+        }
+        inspection = [inspectionCache objectForKey:key];
+        if (inspection != nil)
+                goto exit;
+        if (isFile)
+                inspection = [[PLInterpreterInspection alloc] initWithContentsOfFile:text
+                                                                           firstLine:(NSUInteger)MAX(firstLine, 1)
+                                                                           lineCount:(NSUInteger)MAX(lineCount, 0)
+                                                                               title:title];
+        else
+                inspection = [[PLInterpreterInspection alloc] initWithString:text title:title];
+        [inspection autorelease];
+        if (inspection != nil)
+                [inspectionCache setObject:inspection forKey:key];
+exit:
+        if (PyErr_Occurred())
+                PyErr_Clear();
+        Py_XDECREF(result);
+        Py_XDECREF(module);
+        return inspection;
+}
+
+/**
+ * \brief Show an inspection in a popover below a character of the input.
+ *
+ * \details The popover is created when first needed and reused. Nothing is
+ *          written to the transcript, so that inspecting a large module does
+ *          not grow the text storage.
+ *
+ * \param inspection The inspection.
+ *
+ * \param location The location of the character.
+ */
+-(void)showInspection:(PLInterpreterInspection *)inspection atLocation:(NSUInteger)location
+{
+        NSLayoutManager * layoutManager = [interpreterView layoutManager];
+        PLInterpreterInspectionViewController * contentController;
+        NSRect rect;
+        
+        if (inspectionPopover == nil) {
+                contentController = [[[PLInterpreterInspectionViewController alloc] initWithFont:[interpreterView font]] autorelease];
+                inspectionPopover = [[NSPopover alloc] init];
+                [inspectionPopover setBehavior:NSPopoverBehaviorTransient];
+                [inspectionPopover setContentViewController:contentController];
+                [inspectionPopover setContentSize:[[contentController view] frame].size];
+        }
+        contentController = (PLInterpreterInspectionViewController *)[inspectionPopover contentViewController];
+        [contentController setInspection:inspection];
+        rect = [layoutManager boundingRectForGlyphRange:[layoutManager glyphRangeForCharacterRange:NSMakeRange(location, 1)
+                                                                               actualCharacterRange:NULL]
+                                        inTextContainer:[interpreterView textContainer]];
+        rect = NSOffsetRect(rect, [interpreterView textContainerOrigin].x, [interpreterView textContainerOrigin].y);
+        [inspectionPopover showRelativeToRect:rect ofView:interpreterView preferredEdge:NSMaxYEdge];
+}
+
 #pragma mark Autocomplete
 
 /**
@@ -411,6 +2236,7 @@ exit:
         PyObject * pyDict = NULL;
         PyObject * pyVariables = NULL;
         __block NSString * variablesErrorMessage = nil;
+        [self setUpInterpreter];
 
         inputString = [[interpreterView string] substringWithRange:charRange];
         pyDict = PyModule_GetDict(pyMainModule);
@@ -483,6 +2309,7 @@ exit:
         [[interpreterView textStorage] replaceCharactersInRange:range
                                            withAttributedString:newString];
         [newString release];
+        [self discardInputUndo];
 exit:
         return;
 }
@@ -511,6 +2338,7 @@ exit:
         [[interpreterView textStorage] replaceCharactersInRange:range
                                            withAttributedString:newString];
         [newString release];
+        [self discardInputUndo];
 exit:
         return;
 }
@@ -0,0 +1,252 @@
+/**
+ * \file PLInterpreterDebugger.h
+ * \brief Liasis Python IDE interpreter debugger
+ *
+ * \details This file contains the interface of the debugger running interpreter
+ *          commands with breakpoints.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+#import <Python/frameobject.h>
+
+@class PLInterpreterDebugger;
+
+/**
+ * \brief Return the last line number of a code object.
+ *
+ * \param code The code object.
+ *
+ * \return The largest line number in the line number table of the code.
+ */
+int PLInterpreterDebuggerLastLine(PyCodeObject * code);
+
+/**
+ * \brief The ways to resume a paused command.
+ */
+typedef enum {
+        /**
+         * \brief Run until the next breakpoint.
+         */
+        PLInterpreterDebuggerContinue,
+        
+        /**
+         * \brief Pause at the next line, entering called functions.
+         */
+        PLInterpreterDebuggerStep,
+        
+        /**
+         * \brief Pause at the next line of the paused function, or of its
+         *        caller once it returns.
+         */
+        PLInterpreterDebuggerNext,
+        
+        /**
+         * \brief Stop the command by raising KeyboardInterrupt.
+         */
+        PLInterpreterDebuggerQuit
+} PLInterpreterDebuggerAction;
+
+/**
+ * \protocol PLInterpreterDebuggerDelegate
+ * \brief The object handling the pauses of a debugged command.
+ */
+@protocol PLInterpreterDebuggerDelegate <NSObject>
+
+/**
+ * \brief Handle a pause of the debugged command.
+ *
+ * \details The command is paused until this method returns, on the thread
+ *          running the command and holding the global interpreter lock.
+ *
+ * \param debugger The debugger.
+ *
+ * \param frame The paused frame.
+ *
+ * \return How the command resumes.
+ */
+-(PLInterpreterDebuggerAction)debugger:(PLInterpreterDebugger *)debugger didPauseInFrame:(PyFrameObject *)frame;
+
+@end
+
+/**
+ * \class PLInterpreterDebugger \headerfile \headerfile
+ * \brief Run commands with breakpoints, instrumenting only the code objects
+ *        containing a breakpoint.
+ *
+ * \details Breakpoints are set on a line of a source file or on the first line
+ *          of a function. A debugged command runs with a native trace function
+ *          instead of a Python one, so that no Python code runs for each
+ *          traced event. Whether a code object contains a breakpoint is
+ *          decided on the first event in that code object and cached, and
+ *          events in every other code object return after comparing a pointer,
+ *          so that code without breakpoints runs at nearly full speed. Only
+ *          while stepping are the lines of other code objects examined.
+ *
+ *          Python 2 has no low-overhead monitoring API, so the native trace
+ *          function is the cheapest hook available.
+ *
+ *          Breakpoints are shared by the process, so a single debugger is
+ *          shared by all interpreters.
+ */
+@interface PLInterpreterDebugger : NSObject {
+        /**
+         * \brief The line breakpoints, a dict of absolute file paths to sets
+         *        of line numbers.
+         */
+        PyObject * lineBreakpoints;
+        
+        /**
+         * \brief The absolute paths of the file names of the code objects
+         *        seen, a dict of co_filename strings to paths.
+         */
+        PyObject * absolutePaths;
+        
+        /**
+         * \brief The function breakpoints, a set of code objects.
+         */
+        PyObject * codeBreakpoints;
+        
+        /**
+         * \brief Whether or not each code object seen contains a breakpoint,
+         *        a dict of code objects to booleans.
+         */
+        PyObject * instrumentedCodes;
+        
+        /**
+         * \brief The last code object looked up in instrumentedCodes.
+         */
+        PyCodeObject * lastCode;
+        
+        /**
+         * \brief Whether or not lastCode contains a breakpoint.
+         */
+        BOOL lastCodeInstrumented;
+        
+        /**
+         * \brief How the command resumed from the last pause.
+         */
+        PLInterpreterDebuggerAction action;
+        
+        /**
+         * \brief The frame pausing at its next line while running to the next
+         *        line.
+         */
+        PyFrameObject * stepFrame;
+        
+        /**
+         * \brief The frame of a function breakpoint, pausing at its first
+         *        line.
+         */
+        PyFrameObject * calledFrame;
+        
+        /**
+         * \brief The delegate handling the pauses.
+         */
+        id <PLInterpreterDebuggerDelegate> delegate;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The delegate handling the pauses of debugged commands. The delegate
+ *        is not retained.
+ */
+@property(assign) id <PLInterpreterDebuggerDelegate> delegate;
+
+#pragma mark Shared Debugger
+
+/**
+ * \brief Return the debugger shared by the process.
+ *
+ * \return The shared PLInterpreterDebugger object.
+ */
++(PLInterpreterDebugger *)sharedDebugger;
+
+#pragma mark Breakpoints
+
+/**
+ * \brief Add a breakpoint on a line of a source file.
+ *
+ * \param line The one-based line number.
+ *
+ * \details The path is made absolute, and is compared with the absolute path
+ *          of the co_filename of each code object, which may be relative to
+ *          the current directory.
+ *
+ * \param path The path of the file.
+ */
+-(void)addBreakpointAtLine:(NSInteger)line inFile:(NSString *)path;
+
+/**
+ * \brief Add a breakpoint on the first line of a code object.
+ *
+ * \param code The code object of the function.
+ */
+-(void)addBreakpointInCode:(PyCodeObject *)code;
+
+/**
+ * \brief Remove all breakpoints.
+ */
+-(void)removeAllBreakpoints;
+
+/**
+ * \brief Return descriptions of the breakpoints.
+ *
+ * \return An array of strings describing the breakpoints.
+ */
+-(NSArray *)breakpointDescriptions;
+
+#pragma mark Debugging
+
+/**
+ * \brief Run a code object with the breakpoints.
+ *
+ * \param code The code object.
+ *
+ * \param globals The globals and locals of the code.
+ *
+ * \return A new reference to the result of the code, or NULL with an
+ *         exception set.
+ */
+-(PyObject *)runCode:(PyCodeObject *)code globals:(PyObject *)globals;
+
+/**
+ * \brief Handle a trace event of a debugged command.
+ *
+ * \details This method is called by the native trace function. Calls of
+ *          functions with a breakpoint pause at their first line. Line events
+ *          pause at breakpoints and while stepping, and the return of the
+ *          frame run to its next line moves the step to its caller.
+ *
+ * \param frame The frame of the event.
+ *
+ * \param event The PyTrace event.
+ *
+ * \return 0, or -1 with an exception set to stop the command.
+ */
+-(int)traceFrame:(PyFrameObject *)frame event:(int)event;
+
+@end
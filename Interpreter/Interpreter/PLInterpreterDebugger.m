@@ -0,0 +1,355 @@
+/**
+ * \file PLInterpreterDebugger.m
+ * \brief Liasis Python IDE interpreter debugger
+ *
+ * \details This file contains the implementation of the debugger running
+ *          interpreter commands with breakpoints.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterDebugger.h"
+
+/**
+ * \brief The native trace function of debugged commands.
+ *
+ * \param object The debugger, as passed to PyEval_SetTrace.
+ *
+ * \param frame The frame of the event.
+ *
+ * \param event The PyTrace event.
+ *
+ * \param argument The argument of the event.
+ *
+ * \return 0, or -1 with an exception set to stop the command.
+ */
+static int PLInterpreterDebuggerTrace(PyObject * object, PyFrameObject * frame, int event, PyObject * argument)
+{
+        return [(PLInterpreterDebugger *)PyCObject_AsVoidPtr(object) traceFrame:frame event:event];
+}
+
+int PLInterpreterDebuggerLastLine(PyCodeObject * code)
+{
+        const unsigned char * table = (const unsigned char *)PyString_AS_STRING(code->co_lnotab);
+        Py_ssize_t length = PyString_GET_SIZE(code->co_lnotab), i;
+        int line = code->co_firstlineno;
+        for (i = 1; i < length; i += 2)
+                line += table[i];
+        return line;
+}
+
+#pragma mark -
+
+@implementation PLInterpreterDebugger
+
+@synthesize delegate;
+
+#pragma mark Initialization and Deallocation
+
++(PLInterpreterDebugger *)sharedDebugger
+{
+        static PLInterpreterDebugger * sharedDebugger = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                sharedDebugger = [[PLInterpreterDebugger alloc] init];
+        });
+        return sharedDebugger;
+}
+
+/**
+ * \brief Initialize the PLInterpreterDebugger object without breakpoints.
+ *
+ * \return An initialized PLInterpreterDebugger object.
+ */
+-(id)init
+{
+        PyGILState_STATE state;
+        self = [super init];
+        if (self) {
+                state = PyGILState_Ensure();
+                lineBreakpoints = PyDict_New();
+                codeBreakpoints = PySet_New(NULL);
+                instrumentedCodes = PyDict_New();
+                absolutePaths = PyDict_New();
+                PyGILState_Release(state);
+                action = PLInterpreterDebuggerContinue;
+        }
+        return self;
+}
+
+/**
+ * \brief Release the breakpoints.
+ */
+-(void)dealloc
+{
+        Py_XDECREF(lineBreakpoints);
+        Py_XDECREF(codeBreakpoints);
+        Py_XDECREF(instrumentedCodes);
+        Py_XDECREF(absolutePaths);
+        [super dealloc];
+}
+
+#pragma mark Breakpoints
+
+/**
+ * \brief Forget which code objects contain a breakpoint, after the
+ *        breakpoints change.
+ */
+-(void)breakpointsDidChange
+{
+        PyDict_Clear(instrumentedCodes);
+        PyDict_Clear(absolutePaths);
+        lastCode = NULL;
+}
+
+/**
+ * \brief Return the absolute, standardized form of a path.
+ *
+ * \details Relative paths are resolved against the current directory. Pseudo
+ *          file names such as <string> are returned unchanged.
+ *
+ * \param path The path.
+ *
+ * \return The absolute path.
+ */
+-(NSString *)absolutePath:(NSString *)path
+{
+        if ([path hasPrefix:@"<"])
+                return path;
+        if ([path isAbsolutePath] == NO)
+                path = [[[NSFileManager defaultManager] currentDirectoryPath] stringByAppendingPathComponent:path];
+        return [path stringByStandardizingPath];
+}
+
+/**
+ * \brief Return the line breakpoints in the file of a code object.
+ *
+ * \details The absolute path of each co_filename is computed once, until the
+ *          breakpoints change.
+ *
+ * \param code The code object.
+ *
+ * \return A borrowed reference to the set of line numbers, or NULL.
+ */
+-(PyObject *)lineBreakpointsOfCode:(PyCodeObject *)code
+{
+        PyObject * path;
+        NSString * filename;
+        if (PyDict_Size(lineBreakpoints) == 0)
+                return NULL;
+        path = PyDict_GetItem(absolutePaths, code->co_filename);
+        if (path == NULL) {
+                filename = [NSString stringWithUTF8String:PyString_AS_STRING(code->co_filename)];
+                if ([filename length] == 0)
+                        return PyDict_GetItem(lineBreakpoints, code->co_filename);
+                path = PyString_FromString([[self absolutePath:filename] fileSystemRepresentation]);
+                PyDict_SetItem(absolutePaths, code->co_filename, path);
+                Py_DECREF(path);
+        }
+        return PyDict_GetItem(lineBreakpoints, path);
+}
+
+-(void)addBreakpointAtLine:(NSInteger)line inFile:(NSString *)path
+{
+        const char * absolutePath = [[self absolutePath:path] fileSystemRepresentation];
+        PyObject * lines = PyDict_GetItemString(lineBreakpoints, absolutePath);
+        PyObject * lineNumber = PyInt_FromLong((long)line);
+        if (lines == NULL) {
+                lines = PySet_New(NULL);
+                PyDict_SetItemString(lineBreakpoints, absolutePath, lines);
+                Py_DECREF(lines);
+        }
+        PySet_Add(lines, lineNumber);
+        Py_DECREF(lineNumber);
+        [self breakpointsDidChange];
+}
+
+-(void)addBreakpointInCode:(PyCodeObject *)code
+{
+        PySet_Add(codeBreakpoints, (PyObject *)code);
+        [self breakpointsDidChange];
+}
+
+-(void)removeAllBreakpoints
+{
+        PyDict_Clear(lineBreakpoints);
+        PySet_Clear(codeBreakpoints);
+        [self breakpointsDidChange];
+}
+
+-(NSArray *)breakpointDescriptions
+{
+        NSMutableArray * descriptions = [NSMutableArray array];
+        PyObject * path, * lines, * iterator, * item;
+        PyCodeObject * code;
+        Py_ssize_t position = 0;
+        while (PyDict_Next(lineBreakpoints, &position, &path, &lines)) {
+                iterator = PyObject_GetIter(lines);
+                while ((item = PyIter_Next(iterator)) != NULL) {
+                        [descriptions addObject:[NSString stringWithFormat:@"%s:%ld", PyString_AsString(path), PyInt_AsLong(item)]];
+                        Py_DECREF(item);
+                }
+                Py_DECREF(iterator);
+        }
+        iterator = PyObject_GetIter(codeBreakpoints);
+        while ((item = PyIter_Next(iterator)) != NULL) {
+                code = (PyCodeObject *)item;
+                [descriptions addObject:[NSString stringWithFormat:@"%s (%s:%d)",
+                                         PyString_AsString(code->co_name),
+                                         PyString_AsString(code->co_filename),
+                                         code->co_firstlineno]];
+                Py_DECREF(item);
+        }
+        Py_DECREF(iterator);
+        PyErr_Clear();
+        return descriptions;
+}
+
+#pragma mark Tracing
+
+/**
+ * \brief Return whether or not a code object contains a breakpoint.
+ *
+ * \details The result is cached for each code object, and the last result is
+ *          kept so that consecutive events in the same code object only
+ *          compare a pointer.
+ *
+ * \param code The code object.
+ *
+ * \return YES if the code object contains a breakpoint.
+ */
+-(BOOL)isInstrumentedCode:(PyCodeObject *)code
+{
+        PyObject * cached, * lines, * iterator, * item;
+        int firstLine, lastLine;
+        long line;
+        BOOL instrumented = NO;
+        
+        if (code == lastCode)
+                return lastCodeInstrumented;
+        cached = PyDict_GetItem(instrumentedCodes, (PyObject *)code);
+        if (cached != NULL) {
+                instrumented = (cached == Py_True);
+                goto exit;
+        }
+        instrumented = (PySet_Contains(codeBreakpoints, (PyObject *)code) == 1);
+        lines = (instrumented == NO) ? [self lineBreakpointsOfCode:code] : NULL;
+        if (lines != NULL) {
+                firstLine = code->co_firstlineno;
+                lastLine = PLInterpreterDebuggerLastLine(code);
+                iterator = PyObject_GetIter(lines);
+                while (instrumented == NO && (item = PyIter_Next(iterator)) != NULL) {
+                        line = PyInt_AsLong(item);
+                        instrumented = (line >= firstLine && line <= lastLine);
+                        Py_DECREF(item);
+                }
+                Py_DECREF(iterator);
+        }
+        PyDict_SetItem(instrumentedCodes, (PyObject *)code, instrumented ? Py_True : Py_False);
+exit:
+        lastCode = code;
+        lastCodeInstrumented = instrumented;
+        return instrumented;
+}
+
+/**
+ * \brief Return whether or not a line event hits a breakpoint.
+ *
+ * \param frame The frame of the line event.
+ *
+ * \return YES if the command should pause.
+ */
+-(BOOL)shouldPauseInFrame:(PyFrameObject *)frame
+{
+        PyObject * lines, * lineNumber;
+        BOOL pause;
+        
+        if (action == PLInterpreterDebuggerStep)
+                return YES;
+        if (action == PLInterpreterDebuggerNext && frame == stepFrame)
+                return YES;
+        if ([self isInstrumentedCode:frame->f_code] == NO)
+                return NO;
+        if (frame == calledFrame)
+                return YES;
+        lines = [self lineBreakpointsOfCode:frame->f_code];
+        if (lines == NULL)
+                return NO;
+        lineNumber = PyInt_FromLong(PyFrame_GetLineNumber(frame));
+        pause = (PySet_Contains(lines, lineNumber) == 1);
+        Py_DECREF(lineNumber);
+        return pause;
+}
+
+-(int)traceFrame:(PyFrameObject *)frame event:(int)event
+{
+        switch (event) {
+                case PyTrace_CALL:
+                        if ([self isInstrumentedCode:frame->f_code] && PySet_Contains(codeBreakpoints, (PyObject *)frame->f_code) == 1)
+                                calledFrame = frame;
+                        return 0;
+                case PyTrace_RETURN:
+                        if (frame == stepFrame)
+                                stepFrame = frame->f_back;
+                        if (frame == calledFrame)
+                                calledFrame = NULL;
+                        return 0;
+                case PyTrace_LINE:
+                        break;
+                default:
+                        return 0;
+        }
+        if ([self shouldPauseInFrame:frame] == NO)
+                return 0;
+        calledFrame = NULL;
+        action = [delegate debugger:self didPauseInFrame:frame];
+        stepFrame = (action == PLInterpreterDebuggerNext) ? frame : NULL;
+        if (action == PLInterpreterDebuggerQuit) {
+                PyErr_SetNone(PyExc_KeyboardInterrupt);
+                return -1;
+        }
+        return 0;
+}
+
+#pragma mark Debugging
+
+-(PyObject *)runCode:(PyCodeObject *)code globals:(PyObject *)globals
+{
+        PyObject * result;
+        PyObject * object = PyCObject_FromVoidPtr(self, NULL);
+        action = PLInterpreterDebuggerContinue;
+        stepFrame = NULL;
+        calledFrame = NULL;
+        [self breakpointsDidChange];
+        PyEval_SetTrace(PLInterpreterDebuggerTrace, object);
+        result = PyEval_EvalCode(code, globals, globals);
+        PyEval_SetTrace(NULL, NULL);
+        Py_DECREF(object);
+        action = PLInterpreterDebuggerContinue;
+        stepFrame = NULL;
+        calledFrame = NULL;
+        return result;
+}
+
+@end
@@ -0,0 +1,144 @@
+/**
+ * \file PLInterpreterFileDescriptorCapture.h
+ * \brief Liasis Python IDE interpreter file descriptor capture
+ *
+ * \details This file contains the interface for capturing the standard output
+ *          and standard error file descriptors of the process. Output written
+ *          directly to the descriptors by C extensions and child processes is
+ *          forwarded to the interpreter output sink.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "PLInterpreterOutputSink.h"
+
+/**
+ * \class PLInterpreterFileDescriptorCapture \headerfile \headerfile
+ * \brief Capture output written directly to the stdout and stderr file
+ *        descriptors.
+ *
+ * \details Python-level redirection of sys.stdout and sys.stderr does not see
+ *          output written to file descriptors 1 and 2, such as printf calls
+ *          in C extensions, library warnings, os.system and subprocess
+ *          children. While capturing, this class duplicates the descriptors
+ *          onto pipes and drains the pipes from a dedicated reader thread into
+ *          an output sink. The reader uses large bulk reads so that heavy
+ *          native output does not block the writing process on a full pipe.
+ *
+ *          The file descriptors are shared by the whole process, so a single
+ *          capture object is shared by all interpreters.
+ */
+@interface PLInterpreterFileDescriptorCapture : NSObject {
+        /**
+         * \brief The output sink receiving the captured output.
+         */
+        PLInterpreterOutputSink * outputSink;
+        
+        /**
+         * \brief The read ends of the stdout and stderr pipes.
+         */
+        int readDescriptors[2];
+        
+        /**
+         * \brief Duplicates of the original stdout and stderr descriptors,
+         *        restored when capturing stops.
+         */
+        int savedDescriptors[2];
+        
+        /**
+         * \brief Non-zero while the reader thread is reading from a pipe or
+         *        appending to the output sink.
+         */
+        volatile int32_t readerBusy;
+        
+        /**
+         * \brief Whether or not the descriptors are being captured.
+         */
+        BOOL capturing;
+}
+
+#pragma mark Properties
+
+@property(readonly, getter=isCapturing) BOOL capturing;
+
+#pragma mark Shared Capture
+
+/**
+ * \brief Return the file descriptor capture shared by the process.
+ *
+ * \return The shared PLInterpreterFileDescriptorCapture object.
+ */
++(PLInterpreterFileDescriptorCapture *)sharedCapture;
+
+#pragma mark Capturing
+
+/**
+ * \brief Start capturing the stdout and stderr file descriptors.
+ *
+ * \details Create a pipe for each descriptor, duplicate the write end of the
+ *          pipe onto the descriptor and start the reader thread. Calling this
+ *          method while capturing has no effect.
+ *
+ * \param sink The output sink receiving the captured output.
+ *
+ * \param error On failure, set to an NSError describing the failure.
+ *
+ * \return YES if the descriptors are captured, otherwise NO.
+ */
+-(BOOL)startCapturingToSink:(PLInterpreterOutputSink *)sink error:(NSError **)error;
+
+/**
+ * \brief Stop capturing and restore the original stdout and stderr
+ *        descriptors.
+ *
+ * \details Restoring the descriptors closes the write ends of the pipes, and
+ *          the reader thread exits after draining the remaining output.
+ */
+-(void)stopCapturing;
+
+/**
+ * \brief Wait until the output written to the descriptors so far has been
+ *        appended to the output sink.
+ *
+ * \details Flush the C standard streams, then wait until both pipes are empty
+ *          and the reader thread is idle. The wait is bounded so that a child
+ *          process writing continuously cannot block the caller.
+ */
+-(void)synchronize;
+
+#pragma mark Logging
+
+/**
+ * \brief Log a message without capturing it.
+ *
+ * \details While capturing, the message is written to the system log and to
+ *          the original stderr descriptor, since NSLog would write it to the
+ *          captured descriptor and into the interpreter. Otherwise the message
+ *          is logged with NSLog.
+ *
+ * \param message The message.
+ */
+-(void)logMessage:(NSString *)message;
+
+@end
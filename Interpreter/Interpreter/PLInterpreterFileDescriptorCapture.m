@@ -0,0 +1,252 @@
+/**
+ * \file PLInterpreterFileDescriptorCapture.m
+ * \brief Liasis Python IDE interpreter file descriptor capture
+ *
+ * \details This file contains the implementation for capturing the standard
+ *          output and standard error file descriptors of the process. Output
+ *          written directly to the descriptors by C extensions and child
+ *          processes is forwarded to the interpreter output sink.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterFileDescriptorCapture.h"
+#import <libkern/OSAtomic.h>
+#include <asl.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/**
+ * \brief The size of the buffer used for each read from a pipe.
+ */
+static const size_t PLInterpreterFileDescriptorCaptureReadSize = 64*1024;
+
+/**
+ * \brief The maximum time, in microseconds, that synchronize waits for the
+ *        pipes to drain.
+ */
+static const useconds_t PLInterpreterFileDescriptorCaptureSynchronizeTimeout = 100000;
+
+#pragma mark -
+
+@implementation PLInterpreterFileDescriptorCapture
+
+@synthesize capturing;
+
+#pragma mark Initialization and Deallocation
+
++(PLInterpreterFileDescriptorCapture *)sharedCapture
+{
+        static PLInterpreterFileDescriptorCapture * sharedCapture = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                sharedCapture = [[PLInterpreterFileDescriptorCapture alloc] init];
+        });
+        return sharedCapture;
+}
+
+/**
+ * \brief Initialize the PLInterpreterFileDescriptorCapture object without
+ *        capturing.
+ *
+ * \return An initialized PLInterpreterFileDescriptorCapture object.
+ */
+-(id)init
+{
+        self = [super init];
+        if (self) {
+                readDescriptors[0] = readDescriptors[1] = -1;
+                savedDescriptors[0] = savedDescriptors[1] = -1;
+                readerBusy = 0;
+                capturing = NO;
+        }
+        return self;
+}
+
+/**
+ * \brief Stop capturing and release the output sink.
+ */
+-(void)dealloc
+{
+        [self stopCapturing];
+        [outputSink release];
+        [super dealloc];
+}
+
+#pragma mark Capturing
+
+-(BOOL)startCapturingToSink:(PLInterpreterOutputSink *)sink error:(NSError **)error
+{
+        int pipeDescriptors[2][2] = {{-1, -1}, {-1, -1}};
+        int i, errorNumber = 0;
+        BOOL success = YES;
+        if (capturing)
+                goto exit;
+        fflush(stdout);
+        fflush(stderr);
+        for (i = 0; i < 2; i++) {
+                if (pipe(pipeDescriptors[i]) != 0 || (savedDescriptors[i] = dup(STDOUT_FILENO + i)) < 0) {
+                        errorNumber = errno;
+                        goto error;
+                }
+        }
+        for (i = 0; i < 2; i++) {
+                if (dup2(pipeDescriptors[i][1], STDOUT_FILENO + i) < 0) {
+                        errorNumber = errno;
+                        if (i == 1)
+                                dup2(savedDescriptors[0], STDOUT_FILENO);
+                        goto error;
+                }
+        }
+        for (i = 0; i < 2; i++) {
+                close(pipeDescriptors[i][1]);
+                readDescriptors[i] = pipeDescriptors[i][0];
+        }
+        [outputSink release];
+        outputSink = [sink retain];
+        capturing = YES;
+        [NSThread detachNewThreadSelector:@selector(readPipes) toTarget:self withObject:nil];
+        goto exit;
+error:
+        for (i = 0; i < 2; i++) {
+                if (pipeDescriptors[i][0] >= 0)
+                        close(pipeDescriptors[i][0]);
+                if (pipeDescriptors[i][1] >= 0)
+                        close(pipeDescriptors[i][1]);
+                if (savedDescriptors[i] >= 0)
+                        close(savedDescriptors[i]);
+                savedDescriptors[i] = -1;
+        }
+        if (error != NULL)
+                *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errorNumber userInfo:nil];
+        success = NO;
+exit:
+        return success;
+}
+
+-(void)stopCapturing
+{
+        int i;
+        if (capturing == NO)
+                return;
+        [self synchronize];
+        for (i = 0; i < 2; i++) {
+                dup2(savedDescriptors[i], STDOUT_FILENO + i);
+                close(savedDescriptors[i]);
+                savedDescriptors[i] = -1;
+        }
+        capturing = NO;
+}
+
+-(void)synchronize
+{
+        useconds_t waited = 0;
+        int pending, i;
+        BOOL drained = NO;
+        if (capturing == NO)
+                return;
+        fflush(stdout);
+        fflush(stderr);
+        while (drained == NO && waited < PLInterpreterFileDescriptorCaptureSynchronizeTimeout) {
+                drained = YES;
+                for (i = 0; i < 2; i++) {
+                        pending = 0;
+                        if (ioctl(readDescriptors[i], FIONREAD, &pending) == 0 && pending > 0)
+                                drained = NO;
+                }
+                OSMemoryBarrier();
+                if (readerBusy != 0)
+                        drained = NO;
+                if (drained == NO) {
+                        usleep(500);
+                        waited += 500;
+                }
+        }
+}
+
+#pragma mark Reader Thread
+
+/**
+ * \brief Read from the stdout and stderr pipes until both are closed.
+ *
+ * \details This method runs on the reader thread. It waits for either pipe to
+ *          become readable and appends each bulk read to the output sink. The
+ *          readerBusy flag is set before reading so that synchronize can tell
+ *          when the data taken from a pipe has reached the sink.
+ */
+-(void)readPipes
+{
+        NSAutoreleasePool * pool = [[NSAutoreleasePool alloc] init];
+        struct pollfd pollDescriptors[2];
+        char * buffer = malloc(PLInterpreterFileDescriptorCaptureReadSize);
+        ssize_t count;
+        int i, open = 2;
+        for (i = 0; i < 2; i++) {
+                pollDescriptors[i].fd = readDescriptors[i];
+                pollDescriptors[i].events = POLLIN;
+        }
+        while (open > 0) {
+                if (poll(pollDescriptors, 2, -1) < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        break;
+                }
+                for (i = 0; i < 2; i++) {
+                        if (pollDescriptors[i].fd < 0 || pollDescriptors[i].revents == 0)
+                                continue;
+                        OSAtomicIncrement32Barrier(&readerBusy);
+                        count = read(pollDescriptors[i].fd, buffer, PLInterpreterFileDescriptorCaptureReadSize);
+                        if (count > 0) {
+                                [outputSink appendBytes:buffer length:(NSUInteger)count];
+                        } else if (count == 0 || errno != EINTR) {
+                                close(pollDescriptors[i].fd);
+                                pollDescriptors[i].fd = -1;
+                                open--;
+                        }
+                        OSAtomicDecrement32Barrier(&readerBusy);
+                }
+        }
+        free(buffer);
+        [pool drain];
+}
+
+#pragma mark Logging
+
+-(void)logMessage:(NSString *)message
+{
+        NSString * line;
+        const char * bytes;
+        if (capturing == NO) {
+                NSLog(@"%@", message);
+                return;
+        }
+        asl_log(NULL, NULL, ASL_LEVEL_NOTICE, "%s", [message UTF8String]);
+        line = [NSString stringWithFormat:@"%@[%d] %@\n", [[NSProcessInfo processInfo] processName], getpid(), message];
+        bytes = [line UTF8String];
+        write(savedDescriptors[1], bytes, strlen(bytes));
+}
+
+@end
@@ -0,0 +1,104 @@
+/**
+ * \file PLInterpreterFoldedText.h
+ * \brief Liasis Python IDE interpreter folded text
+ *
+ * \details This file contains the interface for a folded line of interpreter
+ *          output. Lines of output beyond a configurable length are stored
+ *          outside of the text storage and displayed as a short placeholder.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+
+/**
+ * \brief The text attribute marking the placeholder of a folded line. The
+ *        attribute value is the PLInterpreterFoldedText object.
+ */
+extern NSString * const PLInterpreterFoldedTextAttributeName;
+
+/**
+ * \class PLInterpreterFoldedText \headerfile \headerfile
+ * \brief A line of interpreter output folded out of the text storage.
+ *
+ * \details Printing a very large object, such as a JSON document or the repr
+ *          of a long list, produces a single line that is extremely expensive
+ *          for the text system to lay out. Such a line is kept in a folded
+ *          text object, and only a placeholder showing the head and tail of
+ *          the line is added to the text storage. The full line is added to
+ *          the text storage only when the user expands the placeholder, and
+ *          it is copied in full when the placeholder is copied.
+ */
+@interface PLInterpreterFoldedText : NSObject {
+        /**
+         * \brief The full text of the folded line, without its newline.
+         */
+        NSMutableString * text;
+        
+        /**
+         * \brief Whether or not the line is still being written, in which case
+         *        further output continues the folded line.
+         */
+        BOOL open;
+}
+
+#pragma mark Properties
+
+@property(readonly) NSString * text;
+@property(assign, getter=isOpen) BOOL open;
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize a folded line with its text.
+ *
+ * \param aString The text of the line.
+ *
+ * \return An initialized PLInterpreterFoldedText object.
+ */
+-(id)initWithString:(NSString *)aString;
+
+#pragma mark Folded Text
+
+/**
+ * \brief Append output continuing the folded line.
+ *
+ * \param aString The text to append.
+ */
+-(void)appendString:(NSString *)aString;
+
+/**
+ * \brief Return the placeholder displayed in place of the folded line.
+ *
+ * \details The placeholder shows the head and tail of the line around a
+ *          marker giving the number of hidden characters. The whole
+ *          placeholder carries the PLInterpreterFoldedTextAttributeName
+ *          attribute, and the marker is a link to the folded text object.
+ *
+ * \param attributes The attributes of the displayed text.
+ *
+ * \return The placeholder attributed string.
+ */
+-(NSAttributedString *)placeholderWithAttributes:(NSDictionary *)attributes;
+
+@end
@@ -0,0 +1,104 @@
+/**
+ * \file PLInterpreterFoldedText.m
+ * \brief Liasis Python IDE interpreter folded text
+ *
+ * \details This file contains the implementation for a folded line of
+ *          interpreter output. Lines of output beyond a configurable length are
+ *          stored outside of the text storage and displayed as a short
+ *          placeholder.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterFoldedText.h"
+
+NSString * const PLInterpreterFoldedTextAttributeName = @"PLInterpreterFoldedText";
+
+/**
+ * \brief The number of characters of the head and of the tail of a folded line
+ *        shown in its placeholder.
+ */
+static const NSUInteger PLInterpreterFoldedTextContextLength = 200;
+
+#pragma mark -
+
+@implementation PLInterpreterFoldedText
+
+@synthesize text;
+@synthesize open;
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithString:(NSString *)aString
+{
+        self = [super init];
+        if (self) {
+                text = [[NSMutableString alloc] initWithString:aString];
+                open = NO;
+        }
+        return self;
+}
+
+/**
+ * \brief Release the folded text.
+ */
+-(void)dealloc
+{
+        [text release];
+        [super dealloc];
+}
+
+#pragma mark Folded Text
+
+-(void)appendString:(NSString *)aString
+{
+        [text appendString:aString];
+}
+
+-(NSAttributedString *)placeholderWithAttributes:(NSDictionary *)attributes
+{
+        NSMutableAttributedString * placeholder;
+        NSMutableDictionary * placeholderAttributes;
+        NSAttributedString * segment;
+        NSString * marker;
+        NSUInteger length = [text length];
+        NSUInteger contextLength = MIN(PLInterpreterFoldedTextContextLength, length/2);
+        placeholderAttributes = [NSMutableDictionary dictionaryWithDictionary:attributes];
+        [placeholderAttributes setObject:self forKey:PLInterpreterFoldedTextAttributeName];
+        placeholder = [[NSMutableAttributedString alloc] initWithString:[text substringToIndex:contextLength]
+                                                             attributes:placeholderAttributes];
+        marker = [NSString stringWithFormat:@" … [%lu characters folded] … ",
+                  (unsigned long)(length - 2*contextLength)];
+        [placeholderAttributes setObject:self forKey:NSLinkAttributeName];
+        segment = [[NSAttributedString alloc] initWithString:marker attributes:placeholderAttributes];
+        [placeholder appendAttributedString:segment];
+        [segment release];
+        [placeholderAttributes removeObjectForKey:NSLinkAttributeName];
+        segment = [[NSAttributedString alloc] initWithString:[text substringFromIndex:length - contextLength]
+                                                  attributes:placeholderAttributes];
+        [placeholder appendAttributedString:segment];
+        [segment release];
+        return [placeholder autorelease];
+}
+
+@end
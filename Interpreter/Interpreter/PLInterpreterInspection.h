@@ -0,0 +1,163 @@
+/**
+ * \file PLInterpreterInspection.h
+ * \brief Liasis Python IDE interpreter object inspection
+ *
+ * \details This file contains the interface of the paged documentation and
+ *          source of an object inspected in the interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * \class PLInterpreterInspection \headerfile \headerfile
+ * \brief The documentation or source of an object, divided into pages.
+ *
+ * \details An inspection is displayed one page of lines at a time, and only the
+ *          lines of the pages displayed so far are ever scanned. Source is read
+ *          from a memory mapped source file, so that inspecting a large module
+ *          does not read the whole module, and the text of a page is decoded
+ *          only when the page is requested. Pages are separated on line
+ *          boundaries as they are first reached, and the page boundaries found
+ *          are kept, so that going back to an earlier page does not scan again.
+ */
+@interface PLInterpreterInspection : NSObject {
+        /**
+         * \brief The title of the inspection.
+         */
+        NSString * title;
+        
+        /**
+         * \brief The inspected bytes, either a memory mapped file or the UTF-8
+         *        bytes of the documentation.
+         */
+        NSData * contents;
+        
+        /**
+         * \brief The one-based number of the first inspected line.
+         */
+        NSUInteger firstLine;
+        
+        /**
+         * \brief The number of inspected lines, or zero for the rest of the
+         *        contents.
+         */
+        NSUInteger lineLimit;
+        
+        /**
+         * \brief The byte offsets of the page boundaries found so far. Page i
+         *        spans from pageBoundaries[i] to pageBoundaries[i+1].
+         */
+        NSUInteger * pageBoundaries;
+        
+        /**
+         * \brief The number of entries in pageBoundaries.
+         */
+        NSUInteger boundaryCount;
+        
+        /**
+         * \brief The capacity of pageBoundaries.
+         */
+        NSUInteger boundaryCapacity;
+        
+        /**
+         * \brief The number of inspected lines scanned so far.
+         */
+        NSUInteger scannedLineCount;
+        
+        /**
+         * \brief Whether or not the last page boundary has been found.
+         */
+        BOOL scanComplete;
+        
+        /**
+         * \brief Whether or not the line limit has been extended to the end
+         *        of the indented block of the first inspected line.
+         */
+        BOOL blockExtended;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The title of the inspection.
+ */
+@property(readonly) NSString * title;
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize an inspection of documentation.
+ *
+ * \param text The documentation.
+ *
+ * \param aTitle The title of the inspection.
+ *
+ * \return An initialized PLInterpreterInspection object.
+ */
+-(id)initWithString:(NSString *)text title:(NSString *)aTitle;
+
+/**
+ * \brief Initialize an inspection of lines of a source file.
+ *
+ * \details The file is memory mapped, and its lines are read as pages are
+ *          requested.
+ *
+ * \param path The path of the source file.
+ *
+ * \param line The one-based number of the first inspected line.
+ *
+ * \param count The number of inspected lines, or zero for the rest of the
+ *              file. The count is extended by the lines continuing the
+ *              indented block of the first line.
+ *
+ * \param aTitle The title of the inspection.
+ *
+ * \return An initialized PLInterpreterInspection object, or nil if the file
+ *         cannot be mapped.
+ */
+-(id)initWithContentsOfFile:(NSString *)path firstLine:(NSUInteger)line lineCount:(NSUInteger)count title:(NSString *)aTitle;
+
+#pragma mark Pages
+
+/**
+ * \brief Return whether or not a page exists, scanning up to the page if
+ *        needed.
+ *
+ * \param pageIndex The zero-based index of the page.
+ *
+ * \return YES if the page exists.
+ */
+-(BOOL)hasPageAtIndex:(NSUInteger)pageIndex;
+
+/**
+ * \brief Return the text of a page.
+ *
+ * \param pageIndex The zero-based index of the page.
+ *
+ * \return The text of the page, or nil if there is no such page.
+ */
+-(NSString *)pageAtIndex:(NSUInteger)pageIndex;
+
+@end
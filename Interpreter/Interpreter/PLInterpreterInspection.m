@@ -0,0 +1,259 @@
+/**
+ * \file PLInterpreterInspection.m
+ * \brief Liasis Python IDE interpreter object inspection
+ *
+ * \details This file contains the implementation of the paged documentation and
+ *          source of an object inspected in the interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterInspection.h"
+
+/**
+ * \brief The number of lines in a page of an inspection.
+ */
+static const NSUInteger PLInterpreterInspectionLinesPerPage = 60;
+
+/**
+ * \brief Return the indentation of a line.
+ *
+ * \param bytes The contents.
+ *
+ * \param length The length of the contents.
+ *
+ * \param offset The byte offset of the line.
+ *
+ * \return The number of spaces and tabs beginning the line.
+ */
+static NSUInteger PLInterpreterInspectionIndentation(const char * bytes, NSUInteger length, NSUInteger offset)
+{
+        NSUInteger indentation = 0;
+        while (offset + indentation < length && (bytes[offset + indentation] == ' ' || bytes[offset + indentation] == '\t'))
+                indentation++;
+        return indentation;
+}
+
+@implementation PLInterpreterInspection
+
+@synthesize title;
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize an inspection of contents.
+ *
+ * \param data The inspected bytes.
+ *
+ * \param line The one-based number of the first inspected line.
+ *
+ * \param count The number of inspected lines, or zero for the rest of the
+ *              contents.
+ *
+ * \param aTitle The title of the inspection.
+ *
+ * \return An initialized PLInterpreterInspection object.
+ */
+-(id)initWithData:(NSData *)data firstLine:(NSUInteger)line lineCount:(NSUInteger)count title:(NSString *)aTitle
+{
+        self = [super init];
+        if (self) {
+                contents = [data retain];
+                title = [aTitle copy];
+                firstLine = MAX(line, 1);
+                lineLimit = count;
+                boundaryCapacity = 16;
+                pageBoundaries = malloc(boundaryCapacity * sizeof(NSUInteger));
+                boundaryCount = 0;
+        }
+        return self;
+}
+
+-(id)initWithString:(NSString *)text title:(NSString *)aTitle
+{
+        return [self initWithData:[text dataUsingEncoding:NSUTF8StringEncoding]
+                        firstLine:1
+                        lineCount:0
+                            title:aTitle];
+}
+
+-(id)initWithContentsOfFile:(NSString *)path firstLine:(NSUInteger)line lineCount:(NSUInteger)count title:(NSString *)aTitle
+{
+        NSData * data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:NULL];
+        if (data == nil) {
+                [self release];
+                return nil;
+        }
+        return [self initWithData:data firstLine:line lineCount:count title:aTitle];
+}
+
+/**
+ * \brief Release the contents and free the page boundaries.
+ */
+-(void)dealloc
+{
+        free(pageBoundaries);
+        [contents release];
+        [title release];
+        [super dealloc];
+}
+
+#pragma mark Scanning
+
+/**
+ * \brief Return the offset following a number of lines.
+ *
+ * \param count The number of lines to skip.
+ *
+ * \param offset The byte offset of the first line.
+ *
+ * \param skipped Set to the number of lines skipped, which is less than count
+ *                if the contents end first.
+ *
+ * \return The byte offset of the line following the skipped lines, or the
+ *         length of the contents.
+ */
+-(NSUInteger)offsetAfterLines:(NSUInteger)count fromOffset:(NSUInteger)offset skipped:(NSUInteger *)skipped
+{
+        const char * bytes = [contents bytes];
+        NSUInteger length = [contents length];
+        const char * newline;
+        NSUInteger lines = 0;
+        
+        while (lines < count && offset < length) {
+                newline = memchr(bytes + offset, '\n', length - offset);
+                offset = (newline == NULL) ? length : (NSUInteger)(newline - bytes) + 1;
+                lines++;
+        }
+        if (skipped != NULL)
+                *skipped = lines;
+        return offset;
+}
+
+/**
+ * \brief Return the number of lines continuing the indented block of the
+ *        first inspected line.
+ *
+ * \details The line count of a function ends at the first line of its last
+ *          statement, which may continue over the following lines. Lines
+ *          indented deeper than the first inspected line, and blank lines
+ *          followed by such lines, continue the block.
+ *
+ * \param offset The byte offset of the line following the counted lines.
+ *
+ * \return The number of continuation lines.
+ */
+-(NSUInteger)continuationLineCountFromOffset:(NSUInteger)offset
+{
+        const char * bytes = [contents bytes];
+        NSUInteger length = [contents length];
+        NSUInteger baseIndentation = PLInterpreterInspectionIndentation(bytes, length, pageBoundaries[0]);
+        NSUInteger indentation, count = 0, blankCount = 0;
+        const char * newline;
+        char character;
+        
+        while (offset < length) {
+                indentation = PLInterpreterInspectionIndentation(bytes, length, offset);
+                character = (offset + indentation < length) ? bytes[offset + indentation] : '\n';
+                if (character != '\n' && character != '\r') {
+                        if (indentation <= baseIndentation)
+                                break;
+                        count += blankCount + 1;
+                        blankCount = 0;
+                }
+                else
+                        blankCount++;
+                newline = memchr(bytes + offset, '\n', length - offset);
+                offset = (newline == NULL) ? length : (NSUInteger)(newline - bytes) + 1;
+        }
+        return count;
+}
+
+/**
+ * \brief Find the page boundaries up to the end of a page.
+ *
+ * \details Only the lines of the pages up to the requested page are scanned.
+ *          The first scan also skips the lines preceding the first inspected
+ *          line. When the line limit is reached, it is extended by the lines
+ *          continuing the indented block.
+ *
+ * \param pageIndex The zero-based index of the page.
+ */
+-(void)scanToPageAtIndex:(NSUInteger)pageIndex
+{
+        NSUInteger lines, skipped, offset;
+        
+        if (boundaryCount == 0) {
+                pageBoundaries[0] = [self offsetAfterLines:firstLine - 1 fromOffset:0 skipped:NULL];
+                boundaryCount = 1;
+        }
+        while (scanComplete == NO && boundaryCount <= pageIndex + 1) {
+                lines = PLInterpreterInspectionLinesPerPage;
+                if (lineLimit != 0)
+                        lines = MIN(lines, lineLimit - scannedLineCount);
+                offset = [self offsetAfterLines:lines fromOffset:pageBoundaries[boundaryCount - 1] skipped:&skipped];
+                scannedLineCount += skipped;
+                if (skipped == 0) {
+                        scanComplete = YES;
+                        break;
+                }
+                if (boundaryCount == boundaryCapacity) {
+                        boundaryCapacity *= 2;
+                        pageBoundaries = realloc(pageBoundaries, boundaryCapacity * sizeof(NSUInteger));
+                }
+                pageBoundaries[boundaryCount++] = offset;
+                if (lineLimit != 0 && scannedLineCount == lineLimit && blockExtended == NO) {
+                        lineLimit += [self continuationLineCountFromOffset:offset];
+                        blockExtended = YES;
+                }
+                if (offset == [contents length] || (lineLimit != 0 && scannedLineCount == lineLimit))
+                        scanComplete = YES;
+        }
+}
+
+#pragma mark Pages
+
+-(BOOL)hasPageAtIndex:(NSUInteger)pageIndex
+{
+        [self scanToPageAtIndex:pageIndex];
+        return pageIndex + 1 < boundaryCount;
+}
+
+-(NSString *)pageAtIndex:(NSUInteger)pageIndex
+{
+        NSString * page;
+        const char * start;
+        NSUInteger length;
+        
+        if ([self hasPageAtIndex:pageIndex] == NO)
+                return nil;
+        start = (const char *)[contents bytes] + pageBoundaries[pageIndex];
+        length = pageBoundaries[pageIndex + 1] - pageBoundaries[pageIndex];
+        page = [[NSString alloc] initWithBytes:start length:length encoding:NSUTF8StringEncoding];
+        if (page == nil)
+                page = [[NSString alloc] initWithBytes:start length:length encoding:NSISOLatin1StringEncoding];
+        return [page autorelease];
+}
+
+@end
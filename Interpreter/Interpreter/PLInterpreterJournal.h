@@ -0,0 +1,165 @@
+/**
+ * \file PLInterpreterJournal.h
+ * \brief Liasis Python IDE interpreter session journal
+ *
+ * \details This file contains the public interface for journaling the
+ *          interpreter session to disk in the background.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * \brief The key of the input of a recovered journal entry.
+ */
+extern NSString * const PLInterpreterJournalInputKey;
+
+/**
+ * \brief The key of the output of a recovered journal entry.
+ */
+extern NSString * const PLInterpreterJournalOutputKey;
+
+/**
+ * \class PLInterpreterJournal \headerfile \headerfile
+ * \brief Journal the commands of the interpreter session to disk.
+ *
+ * \details Every command run by the interpreter is appended to a journal file
+ *          with its output, so that the session survives a crash of the
+ *          process, for example in a C extension. Appending a record only
+ *          encodes it on the calling thread, and a serial background queue
+ *          writes it, so the main thread never waits on the disk. The input
+ *          of a command is written as soon as the queue runs, so that a
+ *          command crashing the process is recovered without its output. The
+ *          output is committed with all the records appended within a short
+ *          interval with a single write and fsync.
+ *
+ *          The interpreters share the process, so a single journal is shared
+ *          by all interpreters. When the journal is created, the journal of
+ *          the previous session is read. If the previous session did not close
+ *          its journal, its entries are kept for recovery.
+ */
+@interface PLInterpreterJournal : NSObject {
+        /**
+         * \brief The serial queue writing the journal.
+         */
+        dispatch_queue_t writeQueue;
+        
+        /**
+         * \brief The file descriptor of the journal file, or -1 if it could
+         *        not be opened.
+         */
+        int fileDescriptor;
+        
+        /**
+         * \brief The encoded entries waiting to be written. Only used on the
+         *        write queue.
+         */
+        NSMutableData * pendingData;
+        
+        /**
+         * \brief Whether or not a write of the pending entries is scheduled.
+         *        Only used on the write queue.
+         */
+        BOOL writeScheduled;
+        
+        /**
+         * \brief The entries of the previous session if it did not close its
+         *        journal, or nil.
+         */
+        NSArray * recoveredEntries;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The entries of the previous session if it did not close its journal,
+ *        or nil. Each entry is a dictionary with the input and output of a
+ *        command.
+ */
+@property(readonly) NSArray * recoveredEntries;
+
+#pragma mark Shared Journal
+
+/**
+ * \brief Return the journal shared by all interpreters.
+ *
+ * \details The journal is kept in the Liasis folder of the Application Support
+ *          directory of the user.
+ *
+ * \return The shared PLInterpreterJournal object.
+ */
++(PLInterpreterJournal *)sharedJournal;
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize a journal, recovering the journal of the previous session.
+ *
+ * \details The journal of the previous session is renamed with the ".previous"
+ *          extension before the new journal is created. The recovered entries
+ *          are written again at the start of the new journal, so that they
+ *          are not lost if this session does not exit cleanly either.
+ *
+ * \param path The path of the journal file.
+ *
+ * \return An initialized PLInterpreterJournal object.
+ */
+-(id)initWithPath:(NSString *)path;
+
+#pragma mark Journaling
+
+/**
+ * \brief Append the input of a command to the journal before it runs.
+ *
+ * \details The record is encoded on the calling thread, and the write queue
+ *          writes it with the pending records as soon as it runs, without
+ *          waiting for the commit interval, so that they usually survive a
+ *          crash of the process in the command. The write is not synced; the
+ *          next commit syncs it. This method does not wait for the write.
+ *
+ * \param input The input of the command.
+ */
+-(void)appendInput:(NSString *)input;
+
+/**
+ * \brief Append the output of the command last appended to the journal.
+ *
+ * \param output The output of the command.
+ */
+-(void)appendOutput:(NSString *)output;
+
+/**
+ * \brief Forget the recovered entries once they are restored.
+ */
+-(void)discardRecoveredEntries;
+
+/**
+ * \brief Mark the journal as closed and write the pending entries.
+ *
+ * \details This method waits for the write queue. A journal that is closed is
+ *          not recovered on the next launch.
+ */
+-(void)close;
+
+@end
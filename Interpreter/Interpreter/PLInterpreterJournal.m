@@ -0,0 +1,276 @@
+/**
+ * \file PLInterpreterJournal.m
+ * \brief Liasis Python IDE interpreter session journal
+ *
+ * \details This file contains the implementation for journaling the interpreter
+ *          session to disk in the background.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <fcntl.h>
+#import <unistd.h>
+#import "PLInterpreterJournal.h"
+
+NSString * const PLInterpreterJournalInputKey = @"PLInterpreterJournalInput";
+NSString * const PLInterpreterJournalOutputKey = @"PLInterpreterJournalOutput";
+
+/**
+ * \brief The interval during which appended entries are committed together.
+ */
+static const int64_t PLInterpreterJournalCommitInterval = NSEC_PER_SEC/20;
+
+/**
+ * \brief The record tags of the journal.
+ *
+ * \details Each record is a tag character, a space, the decimal length of the
+ *          record bytes, a newline, the UTF-8 record bytes and a newline.
+ */
+enum {
+        PLInterpreterJournalInputTag = 'I',
+        PLInterpreterJournalOutputTag = 'O',
+        PLInterpreterJournalCloseTag = 'C'
+};
+
+/**
+ * \brief Append a record to journal data.
+ *
+ * \param data The data to append the record to.
+ *
+ * \param tag The tag of the record.
+ *
+ * \param string The string of the record.
+ */
+static void PLInterpreterJournalAppendRecord(NSMutableData * data, char tag, NSString * string)
+{
+        const char * bytes = [string UTF8String];
+        size_t length = (bytes != NULL) ? strlen(bytes) : 0;
+        char header[32];
+        int headerLength = snprintf(header, sizeof(header), "%c %zu\n", tag, length);
+        [data appendBytes:header length:(NSUInteger)headerLength];
+        [data appendBytes:bytes length:length];
+        [data appendBytes:"\n" length:1];
+}
+
+#pragma mark -
+
+@implementation PLInterpreterJournal
+
+@synthesize recoveredEntries;
+
+#pragma mark Shared Journal
+
++(PLInterpreterJournal *)sharedJournal
+{
+        static PLInterpreterJournal * sharedJournal = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                NSArray * paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+                NSString * directory = [[paths objectAtIndex:0] stringByAppendingPathComponent:@"Liasis"];
+                [[NSFileManager defaultManager] createDirectoryAtPath:directory
+                                          withIntermediateDirectories:YES
+                                                           attributes:nil
+                                                                error:NULL];
+                sharedJournal = [[PLInterpreterJournal alloc] initWithPath:[directory stringByAppendingPathComponent:@"Interpreter.journal"]];
+        });
+        return sharedJournal;
+}
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithPath:(NSString *)path
+{
+        NSString * previousPath = [path stringByAppendingPathExtension:@"previous"];
+        self = [super init];
+        if (self) {
+                [[NSFileManager defaultManager] removeItemAtPath:previousPath error:NULL];
+                if ([[NSFileManager defaultManager] moveItemAtPath:path toPath:previousPath error:NULL])
+                        recoveredEntries = [[self entriesOfUnclosedJournalAtPath:previousPath] retain];
+                writeQueue = dispatch_queue_create("org.liasis.interpreter.journal", DISPATCH_QUEUE_SERIAL);
+                pendingData = [[NSMutableData alloc] init];
+                writeScheduled = NO;
+                fileDescriptor = open([path fileSystemRepresentation], O_WRONLY | O_CREAT | O_APPEND, 0600);
+                if (fileDescriptor < 0)
+                        NSLog(@"Could not open the interpreter journal at %@: %s", path, strerror(errno));
+                for (NSDictionary * entry in recoveredEntries) {
+                        PLInterpreterJournalAppendRecord(pendingData, PLInterpreterJournalInputTag, [entry objectForKey:PLInterpreterJournalInputKey]);
+                        PLInterpreterJournalAppendRecord(pendingData, PLInterpreterJournalOutputTag, [entry objectForKey:PLInterpreterJournalOutputKey]);
+                }
+                if (recoveredEntries != nil) {
+                        dispatch_async(writeQueue, ^{
+                                [self writePendingDataAndSync:YES];
+                        });
+                }
+        }
+        return self;
+}
+
+/**
+ * \brief Write the pending entries, close the journal file and release the
+ *        pending data.
+ */
+-(void)dealloc
+{
+        dispatch_sync(writeQueue, ^{
+                [self writePendingDataAndSync:YES];
+        });
+        dispatch_release(writeQueue);
+        if (fileDescriptor >= 0)
+                close(fileDescriptor);
+        [pendingData release];
+        [recoveredEntries release];
+        [super dealloc];
+}
+
+#pragma mark Recovery
+
+/**
+ * \brief Read the entries of a journal that was not closed.
+ *
+ * \details A record truncated by the crash ends the journal, and an input
+ *          without its output is recovered with empty output.
+ *
+ * \param path The path of the journal file.
+ *
+ * \return The entries of the journal, or nil if the journal was closed or
+ *         has no entries.
+ */
+-(NSArray *)entriesOfUnclosedJournalAtPath:(NSString *)path
+{
+        NSData * data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL];
+        const char * bytes = [data bytes];
+        const char * end = bytes + [data length];
+        const char * newline;
+        char tag;
+        unsigned long long length;
+        NSString * string;
+        NSString * input = nil;
+        NSMutableArray * entries = [NSMutableArray array];
+        
+        while (bytes < end) {
+                newline = memchr(bytes, '\n', (size_t)(end - bytes));
+                if (newline == NULL || newline - bytes < 3 || bytes[1] != ' ')
+                        break;
+                tag = bytes[0];
+                length = strtoull(bytes + 2, NULL, 10);
+                if ((unsigned long long)(end - newline - 1) < length + 1)
+                        break;
+                string = [[NSString alloc] initWithBytes:newline + 1 length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+                bytes = newline + 1 + length + 1;
+                if (tag == PLInterpreterJournalCloseTag) {
+                        [string release];
+                        return nil;
+                }
+                if (tag == PLInterpreterJournalOutputTag && input != nil) {
+                        [entries addObject:[NSDictionary dictionaryWithObjectsAndKeys:input, PLInterpreterJournalInputKey,
+                                            (string != nil) ? string : @"", PLInterpreterJournalOutputKey, nil]];
+                        input = nil;
+                } else if (tag == PLInterpreterJournalInputTag) {
+                        if (input != nil)
+                                [entries addObject:[NSDictionary dictionaryWithObjectsAndKeys:input, PLInterpreterJournalInputKey,
+                                                    @"", PLInterpreterJournalOutputKey, nil]];
+                        input = [[string retain] autorelease];
+                }
+                [string release];
+        }
+        if (input != nil)
+                [entries addObject:[NSDictionary dictionaryWithObjectsAndKeys:input, PLInterpreterJournalInputKey,
+                                    @"", PLInterpreterJournalOutputKey, nil]];
+        return ([entries count] > 0) ? entries : nil;
+}
+
+-(void)discardRecoveredEntries
+{
+        [recoveredEntries release];
+        recoveredEntries = nil;
+}
+
+#pragma mark Journaling
+
+/**
+ * \brief Write the pending records. Only called on the write queue.
+ *
+ * \param sync Whether or not to sync the journal file after writing.
+ */
+-(void)writePendingDataAndSync:(BOOL)sync
+{
+        const char * bytes = [pendingData bytes];
+        NSUInteger remaining = [pendingData length];
+        ssize_t written;
+        
+        if (fileDescriptor < 0 || remaining == 0)
+                goto exit;
+        while (remaining > 0) {
+                written = write(fileDescriptor, bytes, remaining);
+                if (written < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        NSLog(@"Could not write the interpreter journal: %s", strerror(errno));
+                        goto exit;
+                }
+                bytes += written;
+                remaining -= (NSUInteger)written;
+        }
+        if (sync)
+                fsync(fileDescriptor);
+exit:
+        [pendingData setLength:0];
+}
+
+-(void)appendInput:(NSString *)input
+{
+        NSMutableData * data = [NSMutableData data];
+        PLInterpreterJournalAppendRecord(data, PLInterpreterJournalInputTag, input);
+        dispatch_async(writeQueue, ^{
+                [pendingData appendData:data];
+                [self writePendingDataAndSync:NO];
+        });
+}
+
+-(void)appendOutput:(NSString *)output
+{
+        NSMutableData * data = [NSMutableData data];
+        PLInterpreterJournalAppendRecord(data, PLInterpreterJournalOutputTag, output);
+        dispatch_async(writeQueue, ^{
+                [pendingData appendData:data];
+                if (writeScheduled)
+                        return;
+                writeScheduled = YES;
+                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, PLInterpreterJournalCommitInterval), writeQueue, ^{
+                        writeScheduled = NO;
+                        [self writePendingDataAndSync:YES];
+                });
+        });
+}
+
+-(void)close
+{
+        NSMutableData * data = [NSMutableData data];
+        PLInterpreterJournalAppendRecord(data, PLInterpreterJournalCloseTag, @"");
+        dispatch_sync(writeQueue, ^{
+                [pendingData appendData:data];
+                [self writePendingDataAndSync:YES];
+        });
+}
+
+@end
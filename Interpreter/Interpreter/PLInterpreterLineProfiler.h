@@ -0,0 +1,180 @@
+/**
+ * \file PLInterpreterLineProfiler.h
+ * \brief Liasis Python IDE interpreter line profiler
+ *
+ * \details This file contains the interface of the profiler measuring the time
+ *          spent on each line of selected functions.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+#import <Python/frameobject.h>
+
+/**
+ * \brief The hits and time of the lines of a profiled code object.
+ */
+typedef struct {
+        /**
+         * \brief The profiled code object.
+         */
+        PyCodeObject * code;
+        
+        /**
+         * \brief The first line number of the code object.
+         */
+        int firstLine;
+        
+        /**
+         * \brief The number of lines of the code object.
+         */
+        int lineCount;
+        
+        /**
+         * \brief The number of times each line was executed, indexed by line
+         *        number minus firstLine.
+         */
+        uint64_t * hits;
+        
+        /**
+         * \brief The absolute time spent on each line, including the functions
+         *        it calls, indexed by line number minus firstLine.
+         */
+        uint64_t * times;
+} PLInterpreterLineProfile;
+
+/**
+ * \brief A running frame of a profiled code object.
+ */
+typedef struct {
+        /**
+         * \brief The frame.
+         */
+        PyFrameObject * frame;
+        
+        /**
+         * \brief The profile of the code object of the frame.
+         */
+        PLInterpreterLineProfile * profile;
+        
+        /**
+         * \brief The line being executed, or -1 before the first line.
+         */
+        int line;
+        
+        /**
+         * \brief The absolute time at which the line started.
+         */
+        uint64_t start;
+} PLInterpreterLineProfilerFrame;
+
+/**
+ * \class PLInterpreterLineProfiler \headerfile \headerfile
+ * \brief Count the hits and measure the time of each line of selected code
+ *        objects.
+ *
+ * \details A profiled command runs with a native trace function. Calls of the
+ *          selected code objects push a frame onto a small stack, and line
+ *          events only do work when they belong to the frame on top of the
+ *          stack, so that code that is not selected pays for a pointer
+ *          comparison per line. The time of a line runs until the next line of
+ *          the same frame or its return, and so includes the functions the line
+ *          calls.
+ */
+@interface PLInterpreterLineProfiler : NSObject {
+        /**
+         * \brief The profiles of the selected code objects.
+         */
+        PLInterpreterLineProfile * profiles;
+        
+        /**
+         * \brief The number of entries in profiles.
+         */
+        NSUInteger profileCount;
+        
+        /**
+         * \brief The running frames of the selected code objects, innermost
+         *        last.
+         */
+        PLInterpreterLineProfilerFrame * frames;
+        
+        /**
+         * \brief The number of entries in frames.
+         */
+        NSUInteger frameCount;
+        
+        /**
+         * \brief The capacity of frames.
+         */
+        NSUInteger frameCapacity;
+}
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize a profiler of code objects.
+ *
+ * \details The global interpreter lock must be held.
+ *
+ * \param codes A sequence of code objects.
+ *
+ * \return An initialized PLInterpreterLineProfiler object, or nil if codes
+ *         is not a sequence of code objects.
+ */
+-(id)initWithCodes:(PyObject *)codes;
+
+#pragma mark Profiling
+
+/**
+ * \brief Run a code object, profiling the selected code objects.
+ *
+ * \param code The code object.
+ *
+ * \param globals The globals and locals of the code.
+ *
+ * \return A new reference to the result of the code, or NULL with an
+ *         exception set.
+ */
+-(PyObject *)runCode:(PyCodeObject *)code globals:(PyObject *)globals;
+
+/**
+ * \brief Return the statistics of the profiled lines.
+ *
+ * \return A new reference to a list of (code, [(line, hits, seconds), ...])
+ *         tuples, listing the lines executed at least once.
+ */
+-(PyObject *)statistics;
+
+/**
+ * \brief Handle a trace event of a profiled command.
+ *
+ * \details This method is called by the native trace function.
+ *
+ * \param frame The frame of the event.
+ *
+ * \param event The PyTrace event.
+ */
+-(void)traceFrame:(PyFrameObject *)frame event:(int)event;
+
+@end
@@ -0,0 +1,217 @@
+/**
+ * \file PLInterpreterLineProfiler.m
+ * \brief Liasis Python IDE interpreter line profiler
+ *
+ * \details This file contains the implementation of the profiler measuring the
+ *          time spent on each line of selected functions.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterLineProfiler.h"
+#import "PLInterpreterDebugger.h"
+#import <mach/mach_time.h>
+
+/**
+ * \brief The native trace function of profiled commands.
+ *
+ * \param object The profiler, as passed to PyEval_SetTrace.
+ *
+ * \param frame The frame of the event.
+ *
+ * \param event The PyTrace event.
+ *
+ * \param argument The argument of the event.
+ *
+ * \return 0.
+ */
+static int PLInterpreterLineProfilerTrace(PyObject * object, PyFrameObject * frame, int event, PyObject * argument)
+{
+        [(PLInterpreterLineProfiler *)PyCObject_AsVoidPtr(object) traceFrame:frame event:event];
+        return 0;
+}
+
+#pragma mark -
+
+@implementation PLInterpreterLineProfiler
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithCodes:(PyObject *)codes
+{
+        PyObject * sequence;
+        PyCodeObject * code;
+        NSUInteger i;
+        self = [super init];
+        if (self == nil)
+                return nil;
+        sequence = PySequence_Fast(codes, "codes must be a sequence of code objects");
+        if (sequence == NULL) {
+                [self release];
+                return nil;
+        }
+        profileCount = (NSUInteger)PySequence_Fast_GET_SIZE(sequence);
+        profiles = calloc(MAX(profileCount, 1), sizeof(PLInterpreterLineProfile));
+        for (i = 0; i < profileCount; i++) {
+                code = (PyCodeObject *)PySequence_Fast_GET_ITEM(sequence, i);
+                if (PyCode_Check(code) == NO) {
+                        PyErr_SetString(PyExc_TypeError, "codes must be a sequence of code objects");
+                        Py_DECREF(sequence);
+                        [self release];
+                        return nil;
+                }
+                Py_INCREF(code);
+                profiles[i].code = code;
+                profiles[i].firstLine = code->co_firstlineno;
+                profiles[i].lineCount = PLInterpreterDebuggerLastLine(code) - code->co_firstlineno + 1;
+                profiles[i].hits = calloc(profiles[i].lineCount, sizeof(uint64_t));
+                profiles[i].times = calloc(profiles[i].lineCount, sizeof(uint64_t));
+        }
+        Py_DECREF(sequence);
+        frameCapacity = 64;
+        frames = malloc(frameCapacity * sizeof(PLInterpreterLineProfilerFrame));
+        return self;
+}
+
+/**
+ * \brief Release the code objects and free the profiles.
+ */
+-(void)dealloc
+{
+        NSUInteger i;
+        for (i = 0; i < profileCount; i++) {
+                Py_XDECREF(profiles[i].code);
+                free(profiles[i].hits);
+                free(profiles[i].times);
+        }
+        free(profiles);
+        free(frames);
+        [super dealloc];
+}
+
+#pragma mark Profiling
+
+/**
+ * \brief Add the time since the start of the current line of a frame to the
+ *        line.
+ *
+ * \param entry The running frame.
+ *
+ * \param now The current absolute time.
+ */
+-(void)finishLineOfFrame:(PLInterpreterLineProfilerFrame *)entry atTime:(uint64_t)now
+{
+        int index = entry->line - entry->profile->firstLine;
+        if (entry->line >= 0 && index >= 0 && index < entry->profile->lineCount)
+                entry->profile->times[index] += now - entry->start;
+}
+
+-(void)traceFrame:(PyFrameObject *)frame event:(int)event
+{
+        PLInterpreterLineProfilerFrame * entry;
+        uint64_t now;
+        NSUInteger i;
+        int index;
+        
+        switch (event) {
+                case PyTrace_CALL:
+                        for (i = 0; i < profileCount; i++) {
+                                if (profiles[i].code != frame->f_code)
+                                        continue;
+                                if (frameCount == frameCapacity) {
+                                        frameCapacity *= 2;
+                                        frames = realloc(frames, frameCapacity * sizeof(PLInterpreterLineProfilerFrame));
+                                }
+                                frames[frameCount].frame = frame;
+                                frames[frameCount].profile = &profiles[i];
+                                frames[frameCount].line = -1;
+                                frames[frameCount].start = 0;
+                                frameCount++;
+                                break;
+                        }
+                        break;
+                case PyTrace_LINE:
+                        if (frameCount == 0 || frames[frameCount - 1].frame != frame)
+                                break;
+                        now = mach_absolute_time();
+                        entry = &frames[frameCount - 1];
+                        [self finishLineOfFrame:entry atTime:now];
+                        entry->line = frame->f_lineno;
+                        entry->start = now;
+                        index = entry->line - entry->profile->firstLine;
+                        if (index >= 0 && index < entry->profile->lineCount)
+                                entry->profile->hits[index]++;
+                        break;
+                case PyTrace_RETURN:
+                        if (frameCount == 0 || frames[frameCount - 1].frame != frame)
+                                break;
+                        [self finishLineOfFrame:&frames[frameCount - 1] atTime:mach_absolute_time()];
+                        frameCount--;
+                        break;
+                default:
+                        break;
+        }
+}
+
+-(PyObject *)runCode:(PyCodeObject *)code globals:(PyObject *)globals
+{
+        PyObject * result;
+        PyObject * object = PyCObject_FromVoidPtr(self, NULL);
+        frameCount = 0;
+        PyEval_SetTrace(PLInterpreterLineProfilerTrace, object);
+        result = PyEval_EvalCode(code, globals, globals);
+        PyEval_SetTrace(NULL, NULL);
+        Py_DECREF(object);
+        frameCount = 0;
+        return result;
+}
+
+-(PyObject *)statistics
+{
+        static mach_timebase_info_data_t timebase;
+        PyObject * statistics = PyList_New(0), * lines, * item;
+        NSUInteger i;
+        int j;
+        if (timebase.denom == 0)
+                mach_timebase_info(&timebase);
+        for (i = 0; i < profileCount; i++) {
+                lines = PyList_New(0);
+                for (j = 0; j < profiles[i].lineCount; j++) {
+                        if (profiles[i].hits[j] == 0)
+                                continue;
+                        item = Py_BuildValue("(iKd)",
+                                             profiles[i].firstLine + j,
+                                             (unsigned long long)profiles[i].hits[j],
+                                             (double)profiles[i].times[j] * timebase.numer / timebase.denom / 1e9);
+                        PyList_Append(lines, item);
+                        Py_DECREF(item);
+                }
+                item = Py_BuildValue("(ON)", profiles[i].code, lines);
+                PyList_Append(statistics, item);
+                Py_DECREF(item);
+        }
+        return statistics;
+}
+
+@end
@@ -0,0 +1,79 @@
+/**
+ * \file PLInterpreterNameCheck.h
+ * \brief Liasis Python IDE interpreter name check
+ *
+ * \details This file contains the interface of the static check of the names
+ *          referenced by a command before it runs.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+
+/**
+ * \class PLInterpreterNameCheck \headerfile \headerfile
+ * \brief Find the global names a compiled command reads but never defines.
+ *
+ * \details The bytecode of the command and of the functions and classes it
+ *          defines is scanned once. A global name is defined if the command
+ *          stores it anywhere, if it is in the globals of the interpreter or if
+ *          it is a builtin. Every other name loaded as a global by code running
+ *          with the command, including class bodies and comprehensions, is
+ *          reported. The bodies of the functions it defines are not checked,
+ *          since they may use names defined by later commands. Nothing is
+ *          executed, and the scan is linear in the size of the bytecode, so
+ *          that it takes a few microseconds for a typical command.
+ *
+ *          Like pyflakes, the check is conservative only in one direction: a
+ *          name defined by the command on a branch that is not taken is not
+ *          reported. Commands using exec or import * are not checked, since
+ *          the names they define cannot be known statically.
+ */
+@interface PLInterpreterNameCheck : NSObject
+
+/**
+ * \brief Return the global names a code object reads but never defines.
+ *
+ * \param code The compiled command.
+ *
+ * \param globals The globals the command will run with.
+ *
+ * \return The undefined names, in the order they are first read, or an empty
+ *         array.
+ */
++(NSArray *)undefinedNamesInCode:(PyCodeObject *)code globals:(PyObject *)globals;
+
+/**
+ * \brief Return the global names a code object reads, stores or deletes.
+ *
+ * \details Names read only by the bodies of the functions the code defines are
+ *          not included.
+ *
+ * \param code The compiled command.
+ *
+ * \return The set of names, or nil if the code uses exec or import *.
+ */
++(NSSet *)globalNamesInCode:(PyCodeObject *)code;
+
+@end
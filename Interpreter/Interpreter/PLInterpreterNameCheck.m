@@ -0,0 +1,194 @@
+/**
+ * \file PLInterpreterNameCheck.m
+ * \brief Liasis Python IDE interpreter name check
+ *
+ * \details This file contains the implementation of the static check of the
+ *          names referenced by a command before it runs.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterNameCheck.h"
+#import <Python/opcode.h>
+
+/**
+ * \brief Return whether or not a nested code object always runs when the code
+ *        defining it runs.
+ *
+ * \details Generator expressions and set and dictionary comprehensions are
+ *          called as soon as they are made. Class bodies and lambdas called
+ *          without arguments are recognized by the call following the
+ *          function made from them; lambdas called with arguments are not
+ *          recognized and are treated like the bodies of functions.
+ *
+ * \param code The nested code object.
+ *
+ * \param calledCodes The code objects of the enclosing code whose function is
+ *                    called as soon as it is made.
+ *
+ * \return YES if the code runs with the enclosing code.
+ */
+static BOOL PLNameCheckRunsImmediately(PyCodeObject * code, PyObject * calledCodes)
+{
+        const char * name = PyString_AS_STRING(code->co_name);
+        if (strcmp(name, "<genexpr>") == 0 || strcmp(name, "<setcomp>") == 0 || strcmp(name, "<dictcomp>") == 0)
+                return YES;
+        return PySequence_Contains(calledCodes, (PyObject *)code) == 1;
+}
+
+/**
+ * \brief Scan the bytecode of a code object and of the code objects nested in
+ *        its constants.
+ *
+ * \details Stores are collected from all nested code, since a function
+ *          defined by the command may define a global with a global statement.
+ *          Loads are only collected from code that runs with the command, and
+ *          not from the bodies of the functions it defines, which may read
+ *          globals defined by later commands.
+ *
+ * \param code The code object.
+ *
+ * \param topLevel Whether or not the code runs with the command.
+ *
+ * \param loaded The names loaded as globals by code running with the command,
+ *               appended in order.
+ *
+ * \param stored The names stored or deleted as globals.
+ *
+ * \return NO if the code uses exec or import *, otherwise YES.
+ */
+static BOOL PLNameCheckScanCode(PyCodeObject * code, BOOL topLevel, PyObject * loaded, PyObject * stored)
+{
+        const unsigned char * bytes = (const unsigned char *)PyString_AS_STRING(code->co_code);
+        Py_ssize_t length = PyString_GET_SIZE(code->co_code), i = 0, j;
+        PyObject * name, * constant, * calledCodes = PyList_New(0);
+        PyObject * loadedCode = NULL, * madeCode = NULL;
+        int opcode, argument, extended = 0;
+        BOOL result = YES;
+        
+        while (i < length) {
+                opcode = bytes[i++];
+                argument = 0;
+                if (HAS_ARG(opcode)) {
+                        argument = extended | bytes[i] | (bytes[i + 1] << 8);
+                        i += 2;
+                }
+                extended = 0;
+                if (opcode == CALL_FUNCTION && argument == 0 && madeCode != NULL)
+                        PyList_Append(calledCodes, madeCode);
+                madeCode = (opcode == MAKE_FUNCTION || opcode == MAKE_CLOSURE) ? loadedCode : NULL;
+                loadedCode = NULL;
+                switch (opcode) {
+                        case EXTENDED_ARG:
+                                extended = argument << 16;
+                                break;
+                        case EXEC_STMT:
+                        case IMPORT_STAR:
+                                result = NO;
+                                goto exit;
+                        case LOAD_CONST:
+                                constant = PyTuple_GET_ITEM(code->co_consts, argument);
+                                if (PyCode_Check(constant))
+                                        loadedCode = constant;
+                                break;
+                        case LOAD_NAME:
+                        case LOAD_GLOBAL:
+                                name = PyTuple_GET_ITEM(code->co_names, argument);
+                                if (topLevel)
+                                        PyList_Append(loaded, name);
+                                break;
+                        case STORE_NAME:
+                        case DELETE_NAME:
+                        case STORE_GLOBAL:
+                        case DELETE_GLOBAL:
+                                name = PyTuple_GET_ITEM(code->co_names, argument);
+                                PyDict_SetItem(stored, name, Py_True);
+                                break;
+                        default:
+                                break;
+                }
+        }
+        for (j = 0; j < PyTuple_GET_SIZE(code->co_consts) && result; j++) {
+                constant = PyTuple_GET_ITEM(code->co_consts, j);
+                if (PyCode_Check(constant))
+                        result = PLNameCheckScanCode((PyCodeObject *)constant,
+                                                     topLevel && PLNameCheckRunsImmediately((PyCodeObject *)constant, calledCodes),
+                                                     loaded,
+                                                     stored);
+        }
+exit:
+        Py_XDECREF(calledCodes);
+        return result;
+}
+
+@implementation PLInterpreterNameCheck
+
++(NSArray *)undefinedNamesInCode:(PyCodeObject *)code globals:(PyObject *)globals
+{
+        NSMutableArray * undefinedNames = [NSMutableArray array];
+        PyObject * loaded = PyList_New(0);
+        PyObject * stored = PyDict_New();
+        PyObject * builtins = PyModule_GetDict(PyImport_AddModule("__builtin__"));
+        PyObject * name;
+        Py_ssize_t i;
+        
+        if (loaded == NULL || stored == NULL || PLNameCheckScanCode(code, YES, loaded, stored) == NO)
+                goto exit;
+        for (i = 0; i < PyList_GET_SIZE(loaded); i++) {
+                name = PyList_GET_ITEM(loaded, i);
+                if (PyDict_GetItem(stored, name) != NULL || PyDict_GetItem(globals, name) != NULL || PyDict_GetItem(builtins, name) != NULL)
+                        continue;
+                PyDict_SetItem(stored, name, Py_True);
+                [undefinedNames addObject:[NSString stringWithUTF8String:PyString_AS_STRING(name)]];
+        }
+exit:
+        PyErr_Clear();
+        Py_XDECREF(loaded);
+        Py_XDECREF(stored);
+        return undefinedNames;
+}
+
++(NSSet *)globalNamesInCode:(PyCodeObject *)code
+{
+        NSMutableSet * names = nil;
+        PyObject * loaded = PyList_New(0);
+        PyObject * stored = PyDict_New();
+        PyObject * name, * value;
+        Py_ssize_t i, position = 0;
+        
+        if (loaded == NULL || stored == NULL || PLNameCheckScanCode(code, YES, loaded, stored) == NO)
+                goto exit;
+        names = [NSMutableSet set];
+        for (i = 0; i < PyList_GET_SIZE(loaded); i++)
+                [names addObject:[NSString stringWithUTF8String:PyString_AS_STRING(PyList_GET_ITEM(loaded, i))]];
+        while (PyDict_Next(stored, &position, &name, &value))
+                [names addObject:[NSString stringWithUTF8String:PyString_AS_STRING(name)]];
+exit:
+        PyErr_Clear();
+        Py_XDECREF(loaded);
+        Py_XDECREF(stored);
+        return names;
+}
+
+@end
@@ -0,0 +1,177 @@
+/**
+ * \file PLInterpreterOutputParser.h
+ * \brief Liasis Python IDE interpreter output parser
+ *
+ * \details This file contains the interface for the interpreter output parser.
+ *          It interprets ANSI escape sequences and carriage returns in the
+ *          interpreter output as it is written to the interpreter text storage.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+#import "PLInterpreterFoldedText.h"
+
+/**
+ * \brief The maximum number of parameter characters stored for a single
+ *        control sequence. Longer sequences are truncated.
+ */
+#define PLInterpreterOutputParserMaximumParameterLength 64
+
+/**
+ * \brief The states of the output parser state machine.
+ */
+typedef enum {
+        PLInterpreterOutputParserText,
+        PLInterpreterOutputParserEscape,
+        PLInterpreterOutputParserControlSequence,
+        PLInterpreterOutputParserOperatingSystemCommand,
+        PLInterpreterOutputParserOperatingSystemCommandEscape
+} PLInterpreterOutputParserState;
+
+/**
+ * \class PLInterpreterOutputParser \headerfile \headerfile
+ * \brief Interpret terminal control characters in the interpreter output.
+ *
+ * \details Libraries such as tqdm, rich and colored logging handlers write ANSI
+ *          escape sequences and carriage returns meant for a terminal. The
+ *          output parser is a streaming state machine placed between the
+ *          output sink and the text storage. Select graphic rendition
+ *          sequences are applied as text attributes (colors, bold, italic and
+ *          underline), other escape sequences are dropped, and a carriage
+ *          return overwrites the current line, so that a progress bar redrawn
+ *          many times occupies a single line of the text storage.
+ *
+ *          The parser keeps its state between writes, so escape sequences and
+ *          carriage returns split across chunks of output are handled. Each
+ *          write modifies the text storage at most once, collapsing the line
+ *          redraws within the written string before touching the storage.
+ *
+ *          Lines longer than the folding length are replaced by the
+ *          placeholder of a PLInterpreterFoldedText object, keeping them out
+ *          of the layout system. Output continuing a folded line is appended
+ *          to the folded text instead of the text storage.
+ */
+@interface PLInterpreterOutputParser : NSObject {
+        /**
+         * \brief The current state of the parser.
+         */
+        PLInterpreterOutputParserState state;
+        
+        /**
+         * \brief The parameter characters of the control sequence being
+         *        parsed.
+         */
+        char parameters[PLInterpreterOutputParserMaximumParameterLength + 1];
+        
+        /**
+         * \brief The number of characters stored in the parameters buffer.
+         */
+        NSUInteger parameterLength;
+        
+        /**
+         * \brief Whether or not a carriage return was read and the next
+         *        character should overwrite the current line.
+         */
+        BOOL carriageReturnPending;
+        
+        /**
+         * \brief The text being written by the current call to
+         *        writeString:attributes:toTextStorage:atIndex:.
+         */
+        NSMutableAttributedString * pendingText;
+        
+        /**
+         * \brief The default attributes of the output, as passed to the last
+         *        write.
+         */
+        NSDictionary * defaultAttributes;
+        
+        /**
+         * \brief The attributes of the output for the current graphic
+         *        rendition, or nil if they need to be recomputed.
+         */
+        NSDictionary * currentAttributes;
+        
+        /**
+         * \brief The foreground color set by the output, or nil for the
+         *        default color.
+         */
+        NSColor * foregroundColor;
+        
+        /**
+         * \brief The background color set by the output, or nil for no
+         *        background.
+         */
+        NSColor * backgroundColor;
+        
+        /**
+         * \brief The font traits and decorations set by the output.
+         */
+        BOOL bold, faint, italic, underline;
+        
+        /**
+         * \brief The length beyond which a line of output is folded, or zero
+         *        to never fold lines.
+         */
+        NSUInteger foldingLength;
+}
+
+#pragma mark Properties
+
+@property(assign) NSUInteger foldingLength;
+
+#pragma mark Parsing Output
+
+/**
+ * \brief Write interpreter output to a text storage.
+ *
+ * \details The string is inserted at the given index after interpreting its
+ *          control characters. A carriage return followed by text removes the
+ *          text between the beginning of the line and the insertion point,
+ *          including text written by previous calls. Lines longer than the
+ *          folding length are folded.
+ *
+ * \param string The output to write.
+ *
+ * \param attributes The default attributes of the output, usually the font
+ *                   and text color of the interpreter.
+ *
+ * \param textStorage The text storage to write to.
+ *
+ * \param index The location in the text storage where the output is inserted.
+ *
+ * \return The location in the text storage immediately following the written
+ *         output.
+ */
+-(NSUInteger)writeString:(NSString *)string
+              attributes:(NSDictionary *)attributes
+           toTextStorage:(NSTextStorage *)textStorage
+                 atIndex:(NSUInteger)index;
+
+/**
+ * \brief Reset the graphic rendition and any partially parsed sequence.
+ */
+-(void)reset;
+
+@end
@@ -0,0 +1,518 @@
+/**
+ * \file PLInterpreterOutputParser.m
+ * \brief Liasis Python IDE interpreter output parser
+ *
+ * \details This file contains the implementation for the interpreter output
+ *          parser. It interprets ANSI escape sequences and carriage returns in
+ *          the interpreter output as it is written to the interpreter text
+ *          storage.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterOutputParser.h"
+
+/**
+ * \brief The red, green and blue components of the 16 standard and bright
+ *        terminal colors.
+ */
+static const unsigned char PLInterpreterOutputParserPalette[16][3] = {
+        {0, 0, 0}, {205, 49, 49}, {13, 188, 121}, {229, 229, 16},
+        {36, 114, 200}, {188, 63, 188}, {17, 168, 205}, {229, 229, 229},
+        {102, 102, 102}, {241, 76, 76}, {35, 209, 139}, {245, 245, 67},
+        {59, 142, 234}, {214, 112, 214}, {41, 184, 219}, {255, 255, 255}
+};
+
+/**
+ * \brief Return the color of an entry of the 256 color terminal palette.
+ *
+ * \details Entries 0-15 are the standard and bright colors, 16-231 a 6x6x6
+ *          color cube and 232-255 a grayscale ramp.
+ *
+ * \param index The palette index.
+ *
+ * \return The color of the palette entry.
+ */
+static NSColor * PLInterpreterOutputParserPaletteColor(NSInteger index)
+{
+        CGFloat red, green, blue;
+        NSInteger cube;
+        if (index < 16) {
+                red = PLInterpreterOutputParserPalette[index][0]/255.0;
+                green = PLInterpreterOutputParserPalette[index][1]/255.0;
+                blue = PLInterpreterOutputParserPalette[index][2]/255.0;
+        } else if (index < 232) {
+                cube = index - 16;
+                red = (cube/36) ? (55 + 40*(cube/36))/255.0 : 0.0;
+                green = ((cube/6)%6) ? (55 + 40*((cube/6)%6))/255.0 : 0.0;
+                blue = (cube%6) ? (55 + 40*(cube%6))/255.0 : 0.0;
+        } else {
+                red = green = blue = (8 + 10*(index - 232))/255.0;
+        }
+        return [NSColor colorWithCalibratedRed:red green:green blue:blue alpha:1.0];
+}
+
+#pragma mark -
+
+@implementation PLInterpreterOutputParser
+
+@synthesize foldingLength;
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize the PLInterpreterOutputParser object in the text state
+ *        with the default graphic rendition.
+ *
+ * \return An initialized PLInterpreterOutputParser object.
+ */
+-(id)init
+{
+        self = [super init];
+        if (self) {
+                pendingText = [[NSMutableAttributedString alloc] init];
+                foldingLength = 0;
+                [self reset];
+        }
+        return self;
+}
+
+/**
+ * \brief Release the pending text, attributes and colors.
+ */
+-(void)dealloc
+{
+        [pendingText release];
+        [defaultAttributes release];
+        [currentAttributes release];
+        [foregroundColor release];
+        [backgroundColor release];
+        [super dealloc];
+}
+
+-(void)reset
+{
+        state = PLInterpreterOutputParserText;
+        parameterLength = 0;
+        carriageReturnPending = NO;
+        [self resetGraphicRendition];
+}
+
+#pragma mark Graphic Rendition
+
+/**
+ * \brief Reset the colors, font traits and decorations to their defaults.
+ */
+-(void)resetGraphicRendition
+{
+        [foregroundColor release];
+        foregroundColor = nil;
+        [backgroundColor release];
+        backgroundColor = nil;
+        bold = faint = italic = underline = NO;
+        [currentAttributes release];
+        currentAttributes = nil;
+}
+
+/**
+ * \brief Return the text attributes of the current graphic rendition.
+ *
+ * \return The default attributes with the colors, font traits and decorations
+ *         set by the output applied.
+ */
+-(NSDictionary *)attributes
+{
+        NSMutableDictionary * attributes;
+        NSFont * font;
+        NSColor * color;
+        if (currentAttributes != nil)
+                goto exit;
+        attributes = [NSMutableDictionary dictionaryWithDictionary:defaultAttributes];
+        font = [attributes objectForKey:NSFontAttributeName];
+        if (font != nil && bold)
+                font = [[NSFontManager sharedFontManager] convertFont:font toHaveTrait:NSBoldFontMask];
+        if (font != nil && italic)
+                font = [[NSFontManager sharedFontManager] convertFont:font toHaveTrait:NSItalicFontMask];
+        if (font != nil)
+                [attributes setObject:font forKey:NSFontAttributeName];
+        color = (foregroundColor != nil) ? foregroundColor : [attributes objectForKey:NSForegroundColorAttributeName];
+        if (color != nil && faint)
+                color = [color colorWithAlphaComponent:0.6];
+        if (color != nil)
+                [attributes setObject:color forKey:NSForegroundColorAttributeName];
+        if (backgroundColor != nil)
+                [attributes setObject:backgroundColor forKey:NSBackgroundColorAttributeName];
+        if (underline)
+                [attributes setObject:[NSNumber numberWithInteger:NSUnderlineStyleSingle] forKey:NSUnderlineStyleAttributeName];
+        currentAttributes = [attributes copy];
+exit:
+        return currentAttributes;
+}
+
+/**
+ * \brief Read an extended color from select graphic rendition parameters.
+ *
+ * \details Extended colors are given either as 5;n for an entry of the 256
+ *          color palette, or as 2;r;g;b for a 24-bit color.
+ *
+ * \param values The parameter values.
+ *
+ * \param count The number of parameter values.
+ *
+ * \param index On input, the index of the 38 or 48 parameter. On output, the
+ *              index of the last parameter of the color.
+ *
+ * \return The color, or nil if the parameters are malformed.
+ */
+-(NSColor *)extendedColorFromValues:(const NSInteger *)values count:(NSUInteger)count index:(NSUInteger *)index
+{
+        NSColor * color = nil;
+        NSUInteger i = *index;
+        if (i + 2 < count && values[i+1] == 5) {
+                if (values[i+2] >= 0 && values[i+2] < 256)
+                        color = PLInterpreterOutputParserPaletteColor(values[i+2]);
+                *index = i + 2;
+        } else if (i + 4 < count && values[i+1] == 2) {
+                color = [NSColor colorWithCalibratedRed:MIN(values[i+2], 255)/255.0
+                                                  green:MIN(values[i+3], 255)/255.0
+                                                   blue:MIN(values[i+4], 255)/255.0
+                                                  alpha:1.0];
+                *index = i + 4;
+        } else {
+                *index = count;
+        }
+        return color;
+}
+
+/**
+ * \brief Apply a select graphic rendition sequence using the parsed
+ *        parameters.
+ */
+-(void)applyGraphicRendition
+{
+        NSInteger values[PLInterpreterOutputParserMaximumParameterLength/2 + 1];
+        NSUInteger count = 0, i;
+        NSInteger value;
+        NSColor * color;
+        char * cursor = parameters;
+        char * end;
+        parameters[parameterLength] = '\0';
+        while (count < sizeof(values)/sizeof(values[0])) {
+                value = strtol(cursor, &end, 10);
+                values[count++] = value;
+                if (*end != ';' && *end != ':')
+                        break;
+                cursor = end + 1;
+        }
+        for (i = 0; i < count; i++) {
+                value = values[i];
+                if (value == 0) {
+                        [self resetGraphicRendition];
+                } else if (value == 1) {
+                        bold = YES;
+                } else if (value == 2) {
+                        faint = YES;
+                } else if (value == 3) {
+                        italic = YES;
+                } else if (value == 4) {
+                        underline = YES;
+                } else if (value == 22) {
+                        bold = faint = NO;
+                } else if (value == 23) {
+                        italic = NO;
+                } else if (value == 24) {
+                        underline = NO;
+                } else if ((value >= 30 && value <= 37) || (value >= 90 && value <= 97)) {
+                        [foregroundColor release];
+                        foregroundColor = [PLInterpreterOutputParserPaletteColor(value < 90 ? value - 30 : value - 90 + 8) retain];
+                } else if (value == 38 || value == 48) {
+                        color = [self extendedColorFromValues:values count:count index:&i];
+                        if (value == 38) {
+                                [foregroundColor release];
+                                foregroundColor = [color retain];
+                        } else {
+                                [backgroundColor release];
+                                backgroundColor = [color retain];
+                        }
+                } else if (value == 39) {
+                        [foregroundColor release];
+                        foregroundColor = nil;
+                } else if ((value >= 40 && value <= 47) || (value >= 100 && value <= 107)) {
+                        [backgroundColor release];
+                        backgroundColor = [PLInterpreterOutputParserPaletteColor(value < 100 ? value - 40 : value - 100 + 8) retain];
+                } else if (value == 49) {
+                        [backgroundColor release];
+                        backgroundColor = nil;
+                }
+        }
+        [currentAttributes release];
+        currentAttributes = nil;
+}
+
+#pragma mark Folding Lines
+
+/**
+ * \brief Replace a line of the pending text by the placeholder of a folded
+ *        line.
+ *
+ * \param foldedText The folded line.
+ *
+ * \param lineRange The range of the line in the pending text.
+ *
+ * \return The length of the placeholder.
+ */
+-(NSUInteger)replaceLineInRange:(NSRange)lineRange withFoldedText:(PLInterpreterFoldedText *)foldedText
+{
+        NSAttributedString * placeholder = [foldedText placeholderWithAttributes:[self attributes]];
+        [pendingText replaceCharactersInRange:lineRange withAttributedString:placeholder];
+        return [placeholder length];
+}
+
+/**
+ * \brief Fold the lines of the pending text longer than the folding length.
+ *
+ * \details The first line of the pending text continues the line of the text
+ *          storage before the insertion point. If that line is an open folded
+ *          line, the first line is appended to it and its placeholder is
+ *          replaced. If the two parts together exceed the folding length, the
+ *          storage part is folded with the pending part. Every following line
+ *          is folded on its own. A folded line without a newline is left open.
+ *
+ * \param textStorage The text storage being written to.
+ *
+ * \param replacedRange The range of the text storage that the pending text
+ *                      replaces.
+ */
+-(void)foldLongLinesInTextStorage:(NSTextStorage *)textStorage replacedRange:(NSRange *)replacedRange
+{
+        PLInterpreterFoldedText * foldedText = nil;
+        NSMutableString * lineString;
+        NSRange newline, placeholderRange;
+        NSUInteger location, lineEnd, lineStart;
+        BOOL firstLine = YES;
+        if (foldingLength == 0)
+                return;
+        location = 0;
+        do {
+                newline = [[pendingText string] rangeOfString:@"\n"
+                                                      options:0
+                                                        range:NSMakeRange(location, [pendingText length] - location)];
+                lineEnd = (newline.location == NSNotFound) ? [pendingText length] : newline.location;
+                if (firstLine && replacedRange->location > 0)
+                        foldedText = [textStorage attribute:PLInterpreterFoldedTextAttributeName
+                                                    atIndex:replacedRange->location - 1
+                                      longestEffectiveRange:&placeholderRange
+                                                    inRange:NSMakeRange(0, replacedRange->location)];
+                if (firstLine && [foldedText isOpen]) {
+                        [foldedText appendString:[[pendingText string] substringToIndex:lineEnd]];
+                        [foldedText setOpen:(newline.location == NSNotFound)];
+                        lineEnd = [self replaceLineInRange:NSMakeRange(0, lineEnd) withFoldedText:foldedText];
+                        replacedRange->length += replacedRange->location - placeholderRange.location;
+                        replacedRange->location = placeholderRange.location;
+                } else if (firstLine) {
+                        newline = [[textStorage string] rangeOfString:@"\n"
+                                                              options:NSBackwardsSearch
+                                                                range:NSMakeRange(0, replacedRange->location)];
+                        lineStart = (newline.location == NSNotFound) ? 0 : NSMaxRange(newline);
+                        if (lineEnd > 0 && replacedRange->location - lineStart + lineEnd > foldingLength) {
+                                lineString = [NSMutableString stringWithString:[[textStorage string] substringWithRange:NSMakeRange(lineStart, replacedRange->location - lineStart)]];
+                                [lineString appendString:[[pendingText string] substringToIndex:lineEnd]];
+                                foldedText = [[PLInterpreterFoldedText alloc] initWithString:lineString];
+                                [foldedText setOpen:(lineEnd == [pendingText length])];
+                                lineEnd = [self replaceLineInRange:NSMakeRange(0, lineEnd) withFoldedText:foldedText];
+                                [foldedText release];
+                                replacedRange->length += replacedRange->location - lineStart;
+                                replacedRange->location = lineStart;
+                        }
+                } else if (lineEnd - location > foldingLength) {
+                        foldedText = [[PLInterpreterFoldedText alloc] initWithString:[[pendingText string] substringWithRange:NSMakeRange(location, lineEnd - location)]];
+                        [foldedText setOpen:(lineEnd == [pendingText length])];
+                        lineEnd = location + [self replaceLineInRange:NSMakeRange(location, lineEnd - location) withFoldedText:foldedText];
+                        [foldedText release];
+                }
+                firstLine = NO;
+                location = lineEnd + 1;
+        } while (location <= [pendingText length]);
+}
+
+#pragma mark Parsing Output
+
+/**
+ * \brief Append a range of the output to the pending text with the current
+ *        attributes.
+ *
+ * \param string The output being written.
+ *
+ * \param range The range of plain text in the output.
+ */
+-(void)appendText:(NSString *)string range:(NSRange)range
+{
+        NSAttributedString * text;
+        if (range.length == 0)
+                return;
+        text = [[NSAttributedString alloc] initWithString:[string substringWithRange:range]
+                                               attributes:[self attributes]];
+        [pendingText appendAttributedString:text];
+        [text release];
+}
+
+/**
+ * \brief Overwrite the current line after a carriage return.
+ *
+ * \details If the pending text contains a newline, the pending text after the
+ *          last newline is removed. Otherwise the whole pending text is
+ *          removed, and the replaced range of the text storage is extended
+ *          back to the beginning of the line containing the insertion point.
+ *
+ * \param textStorage The text storage being written to.
+ *
+ * \param replacedRange The range of the text storage that the pending text
+ *                      replaces.
+ */
+-(void)returnCarriageInTextStorage:(NSTextStorage *)textStorage replacedRange:(NSRange *)replacedRange
+{
+        NSRange newline = [[pendingText mutableString] rangeOfString:@"\n" options:NSBackwardsSearch];
+        NSUInteger lineStart;
+        if (newline.location != NSNotFound) {
+                [pendingText deleteCharactersInRange:NSMakeRange(NSMaxRange(newline), [pendingText length] - NSMaxRange(newline))];
+                return;
+        }
+        [pendingText deleteCharactersInRange:NSMakeRange(0, [pendingText length])];
+        newline = [[textStorage string] rangeOfString:@"\n"
+                                              options:NSBackwardsSearch
+                                                range:NSMakeRange(0, replacedRange->location)];
+        lineStart = (newline.location == NSNotFound) ? 0 : NSMaxRange(newline);
+        replacedRange->length += replacedRange->location - lineStart;
+        replacedRange->location = lineStart;
+}
+
+/**
+ * \brief Handle the final character of a control sequence.
+ *
+ * \details Select graphic rendition ('m') sequences are applied. An erase in
+ *          line ('K') sequence following a carriage return clears the line.
+ *          Other sequences, such as cursor movement, are ignored.
+ *
+ * \param finalCharacter The final character of the control sequence.
+ *
+ * \param textStorage The text storage being written to.
+ *
+ * \param replacedRange The range of the text storage that the pending text
+ *                      replaces.
+ */
+-(void)handleControlSequence:(unichar)finalCharacter textStorage:(NSTextStorage *)textStorage replacedRange:(NSRange *)replacedRange
+{
+        if (finalCharacter == 'm') {
+                [self applyGraphicRendition];
+        } else if (finalCharacter == 'K' && carriageReturnPending) {
+                carriageReturnPending = NO;
+                [self returnCarriageInTextStorage:textStorage replacedRange:replacedRange];
+        }
+        parameterLength = 0;
+}
+
+-(NSUInteger)writeString:(NSString *)string
+              attributes:(NSDictionary *)attributes
+           toTextStorage:(NSTextStorage *)textStorage
+                 atIndex:(NSUInteger)index
+{
+        CFStringInlineBuffer buffer;
+        NSRange replacedRange = NSMakeRange(index, 0);
+        NSUInteger length = [string length];
+        NSUInteger i, runStart = 0;
+        NSUInteger pendingLength;
+        unichar character;
+        if (![attributes isEqualToDictionary:defaultAttributes]) {
+                [defaultAttributes release];
+                defaultAttributes = [attributes copy];
+                [currentAttributes release];
+                currentAttributes = nil;
+        }
+        [pendingText deleteCharactersInRange:NSMakeRange(0, [pendingText length])];
+        CFStringInitInlineBuffer((CFStringRef)string, &buffer, CFRangeMake(0, length));
+        for (i = 0; i < length; i++) {
+                character = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+                switch (state) {
+                        case PLInterpreterOutputParserText:
+                                if (carriageReturnPending && character != '\r' && character != 0x1B) {
+                                        carriageReturnPending = NO;
+                                        if (character != '\n')
+                                                [self returnCarriageInTextStorage:textStorage replacedRange:&replacedRange];
+                                }
+                                if (character == 0x1B) {
+                                        [self appendText:string range:NSMakeRange(runStart, i - runStart)];
+                                        state = PLInterpreterOutputParserEscape;
+                                        runStart = i + 1;
+                                } else if (character == '\r') {
+                                        [self appendText:string range:NSMakeRange(runStart, i - runStart)];
+                                        carriageReturnPending = YES;
+                                        runStart = i + 1;
+                                } else if (character == '\b' || character == 0x07) {
+                                        [self appendText:string range:NSMakeRange(runStart, i - runStart)];
+                                        pendingLength = [pendingText length];
+                                        if (character == '\b' && pendingLength > 0 && [[pendingText string] characterAtIndex:pendingLength - 1] != '\n')
+                                                [pendingText deleteCharactersInRange:NSMakeRange(pendingLength - 1, 1)];
+                                        runStart = i + 1;
+                                }
+                                break;
+                        case PLInterpreterOutputParserEscape:
+                                if (character == '[')
+                                        state = PLInterpreterOutputParserControlSequence;
+                                else if (character == ']')
+                                        state = PLInterpreterOutputParserOperatingSystemCommand;
+                                else
+                                        state = PLInterpreterOutputParserText;
+                                parameterLength = 0;
+                                runStart = i + 1;
+                                break;
+                        case PLInterpreterOutputParserControlSequence:
+                                if (character >= 0x40 && character <= 0x7E) {
+                                        [self handleControlSequence:character textStorage:textStorage replacedRange:&replacedRange];
+                                        state = PLInterpreterOutputParserText;
+                                } else if (parameterLength < PLInterpreterOutputParserMaximumParameterLength) {
+                                        parameters[parameterLength++] = (char)character;
+                                }
+                                runStart = i + 1;
+                                break;
+                        case PLInterpreterOutputParserOperatingSystemCommand:
+                                if (character == 0x07)
+                                        state = PLInterpreterOutputParserText;
+                                else if (character == 0x1B)
+                                        state = PLInterpreterOutputParserOperatingSystemCommandEscape;
+                                runStart = i + 1;
+                                break;
+                        case PLInterpreterOutputParserOperatingSystemCommandEscape:
+                                state = PLInterpreterOutputParserText;
+                                runStart = i + 1;
+                                break;
+                }
+        }
+        if (state == PLInterpreterOutputParserText)
+                [self appendText:string range:NSMakeRange(runStart, length - runStart)];
+        [self foldLongLinesInTextStorage:textStorage replacedRange:&replacedRange];
+        if (replacedRange.length > 0 || [pendingText length] > 0)
+                [textStorage replaceCharactersInRange:replacedRange withAttributedString:pendingText];
+        return replacedRange.location + [pendingText length];
+}
+
+@end
@@ -0,0 +1,190 @@
+/**
+ * \file PLInterpreterOutputSink.h
+ * \brief Liasis Python IDE interpreter output sink
+ *
+ * \details This file contains the interface for the interpreter output sink. It
+ *          collects the output written by the Python interpreter and by native
+ *          code into chunks until the interpreter controller displays it.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * \brief A chunk of output in the output sink, linked to the chunk written
+ *        before it.
+ */
+typedef struct PLInterpreterOutputChunk {
+        /**
+         * \brief The chunk written before this chunk.
+         */
+        struct PLInterpreterOutputChunk * previous;
+        
+        /**
+         * \brief The number of bytes in the chunk.
+         */
+        NSUInteger length;
+        
+        /**
+         * \brief The UTF-8 encoded bytes of the chunk.
+         */
+        char bytes[];
+} PLInterpreterOutputChunk;
+
+/**
+ * \class PLInterpreterOutputSink \headerfile \headerfile
+ * \brief Collect interpreter output until it is displayed.
+ *
+ * \details The output sink is a multiple producer, single consumer queue of
+ *          output chunks. Writers on any thread, such as background Python
+ *          threads and the file descriptor reader, append a chunk by pushing it
+ *          onto a linked list with an atomic compare and swap. No lock is
+ *          taken, so writers neither wait on each other nor need the Python
+ *          global interpreter lock. The interpreter controller is the single
+ *          consumer: it detaches the whole list with one atomic swap and
+ *          restores the writing order before decoding it.
+ *
+ *          Copies are kept to a minimum. Writers copy their bytes into the
+ *          chunk once, and UTF-16 text is encoded straight into the chunk. A
+ *          drain of a single chunk creates the string over the chunk bytes
+ *          without copying, and a drain of several chunks joins them with one
+ *          copy. The bytes appended and copied are counted, so that the copies
+ *          per byte of output can be measured. Only output goes through the
+ *          sink; the input of a command is copied from the interpreter view
+ *          and encoded as UTF-8 for the compiler as before.
+ *
+ *          Python and native output share a single sink, since sys.stdout,
+ *          sys.stderr and the process file descriptors are shared by every
+ *          interpreter in the process.
+ *
+ * \see PLInterpreterFileDescriptorCapture
+ */
+@interface PLInterpreterOutputSink : NSObject {
+        /**
+         * \brief The most recently written chunk, or NULL if the sink is
+         *        empty. Modified only with atomic operations.
+         */
+        PLInterpreterOutputChunk * volatile lastChunk;
+        
+        /**
+         * \brief The bytes of an incomplete UTF-8 character at the end of the
+         *        last drained output. Only accessed by the consumer.
+         */
+        NSMutableData * incompleteCharacter;
+        
+        /**
+         * \brief The number of bytes of output appended to the sink. Modified
+         *        only with atomic operations.
+         */
+        volatile int64_t appendedByteCount;
+        
+        /**
+         * \brief The number of bytes copied or transcoded by the sink, from
+         *        the writer to the drained string. Modified only with atomic
+         *        operations.
+         */
+        volatile int64_t copiedByteCount;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The number of bytes of output appended to the sink.
+ */
+@property(readonly) int64_t appendedByteCount;
+
+/**
+ * \brief The number of bytes copied or transcoded between the writers and the
+ *        drained strings. Dividing by appendedByteCount gives the copies per
+ *        byte of output.
+ */
+@property(readonly) int64_t copiedByteCount;
+
+#pragma mark Shared Sink
+
+/**
+ * \brief Return the output sink shared by the interpreters of the process.
+ *
+ * \return The shared PLInterpreterOutputSink object.
+ */
++(PLInterpreterOutputSink *)sharedSink;
+
+#pragma mark Writing Output
+
+/**
+ * \brief Append UTF-8 encoded bytes to the sink.
+ *
+ * \details This method copies the bytes into a new chunk and may be called
+ *          from any thread without holding a lock or the Python global
+ *          interpreter lock.
+ *
+ * \param bytes A pointer to the bytes to append.
+ *
+ * \param byteLength The number of bytes to append.
+ */
+-(void)appendBytes:(const void *)bytes length:(NSUInteger)byteLength;
+
+/**
+ * \brief Append UTF-16 encoded characters to the sink.
+ *
+ * \details The characters are encoded as UTF-8 directly into a new chunk,
+ *          through a string that does not copy them. Like appendBytes:length:,
+ *          this method may be called from any thread.
+ *
+ * \param characters A pointer to the characters to append.
+ *
+ * \param length The number of characters to append.
+ */
+-(void)appendCharacters:(const unichar *)characters length:(NSUInteger)length;
+
+#pragma mark Reading Output
+
+/**
+ * \brief Return whether or not output is waiting to be drained.
+ *
+ * \return YES if a chunk has been written since the last drain, otherwise NO.
+ */
+-(BOOL)hasPendingOutput;
+
+/**
+ * \brief Remove the pending output from the sink and return it as a string.
+ *
+ * \details The pending chunks are decoded as UTF-8. If the output ends in
+ *          the middle of a multibyte character, the incomplete character is
+ *          kept until the next drain. Output that is not valid UTF-8 is
+ *          decoded as Latin-1. This method must only be called from a single
+ *          thread, which in practice is the main thread.
+ *
+ * \return The pending output, or an empty string if there is no output.
+ */
+-(NSString *)drainString;
+
+#pragma mark Copy Statistics
+
+/**
+ * \brief Reset the counts of appended and copied bytes.
+ */
+-(void)resetCopyStatistics;
+
+@end
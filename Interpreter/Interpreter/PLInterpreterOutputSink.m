@@ -0,0 +1,318 @@
+/**
+ * \file PLInterpreterOutputSink.m
+ * \brief Liasis Python IDE interpreter output sink
+ *
+ * \details This file contains the implementation for the interpreter output
+ *          sink. It collects the output written by the Python interpreter and
+ *          by native code into chunks until the interpreter controller displays
+ *          it.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterOutputSink.h"
+#import <libkern/OSAtomic.h>
+#import <stddef.h>
+
+/**
+ * \brief Return the length of the longest prefix of a UTF-8 buffer that does
+ *        not end in an incomplete multibyte character.
+ *
+ * \param bytes The UTF-8 encoded buffer.
+ *
+ * \param byteLength The length of the buffer.
+ *
+ * \return The length of the complete prefix of the buffer.
+ */
+static NSUInteger PLUTF8CompletePrefixLength(const unsigned char * bytes, NSUInteger byteLength)
+{
+        NSUInteger start, expected;
+        NSUInteger completeLength = byteLength;
+        unsigned char leadByte;
+        if (byteLength == 0)
+                goto exit;
+        start = byteLength;
+        while (start > 0 && byteLength - start < 4 && (bytes[start-1] & 0xC0) == 0x80)
+                start--;
+        if (start == 0)
+                goto exit;
+        leadByte = bytes[start-1];
+        if ((leadByte & 0xE0) == 0xC0)
+                expected = 2;
+        else if ((leadByte & 0xF0) == 0xE0)
+                expected = 3;
+        else if ((leadByte & 0xF8) == 0xF0)
+                expected = 4;
+        else
+                goto exit;
+        if (byteLength - start + 1 < expected)
+                completeLength = start - 1;
+exit:
+        return completeLength;
+}
+
+/**
+ * \brief Allocate memory for the chunk allocator.
+ */
+static void * PLOutputChunkAllocate(CFIndex size, CFOptionFlags hint, void * info)
+{
+        return malloc((size_t)size);
+}
+
+/**
+ * \brief Free the chunk containing the bytes of a drained string.
+ *
+ * \param bytes The bytes of the chunk, following its header.
+ *
+ * \param info Unused.
+ */
+static void PLOutputChunkDeallocate(void * bytes, void * info)
+{
+        free((char *)bytes - offsetof(PLInterpreterOutputChunk, bytes));
+}
+
+/**
+ * \brief Return the allocator freeing the chunk of a string created over the
+ *        bytes of a chunk.
+ *
+ * \return The chunk allocator.
+ */
+static CFAllocatorRef PLOutputChunkAllocator(void)
+{
+        static CFAllocatorRef allocator = NULL;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                CFAllocatorContext context = {0, NULL, NULL, NULL, NULL, PLOutputChunkAllocate, NULL, PLOutputChunkDeallocate, NULL};
+                allocator = CFAllocatorCreate(kCFAllocatorDefault, &context);
+        });
+        return allocator;
+}
+
+/**
+ * \brief Create a string over UTF-8 bytes without copying them, if possible.
+ *
+ * \details The string takes ownership of the bytes, and frees them with the
+ *          deallocator. Core Foundation keeps ASCII bytes as they are, and
+ *          transcodes other text, so the number of bytes copied is returned.
+ *          Bytes that are not valid UTF-8 are decoded as Latin-1.
+ *
+ * \param bytes The bytes.
+ *
+ * \param length The number of bytes.
+ *
+ * \param deallocator The allocator freeing the bytes.
+ *
+ * \param copiedLength On return, the number of bytes copied.
+ *
+ * \return The string, autoreleased.
+ */
+static NSString * PLOutputStringWithBytesNoCopy(char * bytes, NSUInteger length, CFAllocatorRef deallocator, NSUInteger * copiedLength)
+{
+        CFStringRef string;
+        *copiedLength = 0;
+        if (length == 0) {
+                CFAllocatorDeallocate(deallocator, bytes);
+                return @"";
+        }
+        string = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *)bytes, (CFIndex)length, kCFStringEncodingUTF8, false, deallocator);
+        if (string == NULL)
+                string = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *)bytes, (CFIndex)length, kCFStringEncodingISOLatin1, false, deallocator);
+        *copiedLength = (CFStringGetCStringPtr(string, kCFStringEncodingASCII) == bytes) ? 0 : length;
+        return [(NSString *)string autorelease];
+}
+
+#pragma mark -
+
+@implementation PLInterpreterOutputSink
+
+@synthesize appendedByteCount;
+@synthesize copiedByteCount;
+
+#pragma mark Initialization and Deallocation
+
++(PLInterpreterOutputSink *)sharedSink
+{
+        static PLInterpreterOutputSink * sharedSink = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                sharedSink = [[PLInterpreterOutputSink alloc] init];
+        });
+        return sharedSink;
+}
+
+/**
+ * \brief Initialize the PLInterpreterOutputSink object with no pending
+ *        output.
+ *
+ * \return An initialized PLInterpreterOutputSink object.
+ */
+-(id)init
+{
+        self = [super init];
+        if (self) {
+                lastChunk = NULL;
+                incompleteCharacter = [[NSMutableData alloc] init];
+                appendedByteCount = 0;
+                copiedByteCount = 0;
+        }
+        return self;
+}
+
+/**
+ * \brief Free the pending chunks and release the incomplete character data.
+ */
+-(void)dealloc
+{
+        PLInterpreterOutputChunk * chunk = lastChunk;
+        PLInterpreterOutputChunk * previous;
+        while (chunk != NULL) {
+                previous = chunk->previous;
+                free(chunk);
+                chunk = previous;
+        }
+        [incompleteCharacter release];
+        [super dealloc];
+}
+
+#pragma mark Writing Output
+
+/**
+ * \brief Push a filled chunk onto the list of pending chunks.
+ *
+ * \param chunk The chunk.
+ */
+-(void)pushChunk:(PLInterpreterOutputChunk *)chunk
+{
+        OSAtomicAdd64Barrier((int64_t)chunk->length, &appendedByteCount);
+        OSAtomicAdd64Barrier((int64_t)chunk->length, &copiedByteCount);
+        do {
+                chunk->previous = lastChunk;
+        } while (!OSAtomicCompareAndSwapPtrBarrier(chunk->previous, chunk, (void * volatile *)&lastChunk));
+}
+
+-(void)appendBytes:(const void *)bytes length:(NSUInteger)byteLength
+{
+        PLInterpreterOutputChunk * chunk;
+        if (byteLength == 0)
+                return;
+        chunk = malloc(sizeof(PLInterpreterOutputChunk) + byteLength);
+        if (chunk == NULL)
+                return;
+        chunk->length = byteLength;
+        memcpy(chunk->bytes, bytes, byteLength);
+        [self pushChunk:chunk];
+}
+
+-(void)appendCharacters:(const unichar *)characters length:(NSUInteger)length
+{
+        PLInterpreterOutputChunk * chunk;
+        CFStringRef string;
+        CFIndex usedLength = 0;
+        if (length == 0)
+                return;
+        chunk = malloc(sizeof(PLInterpreterOutputChunk) + 3 * length);
+        if (chunk == NULL)
+                return;
+        string = CFStringCreateWithCharactersNoCopy(kCFAllocatorDefault, characters, (CFIndex)length, kCFAllocatorNull);
+        CFStringGetBytes(string, CFRangeMake(0, (CFIndex)length), kCFStringEncodingUTF8, '?', false,
+                         (UInt8 *)chunk->bytes, (CFIndex)(3 * length), &usedLength);
+        CFRelease(string);
+        chunk->length = (NSUInteger)usedLength;
+        [self pushChunk:chunk];
+}
+
+#pragma mark Reading Output
+
+-(BOOL)hasPendingOutput
+{
+        OSMemoryBarrier();
+        return lastChunk != NULL;
+}
+
+-(NSString *)drainString
+{
+        PLInterpreterOutputChunk * chunk;
+        PLInterpreterOutputChunk * first = NULL;
+        PLInterpreterOutputChunk * next;
+        char * pending = NULL;
+        NSString * output = @"";
+        NSUInteger completeLength, pendingLength, copiedLength = 0;
+        do {
+                chunk = lastChunk;
+        } while (!OSAtomicCompareAndSwapPtrBarrier(chunk, NULL, (void * volatile *)&lastChunk));
+        if (chunk == NULL)
+                goto exit;
+        
+        pendingLength = [incompleteCharacter length];
+        while (chunk != NULL) {
+                next = chunk->previous;
+                chunk->previous = first;
+                first = chunk;
+                pendingLength += chunk->length;
+                chunk = next;
+        }
+        
+        /* A single chunk becomes the string without being copied. */
+        if (first->previous == NULL && [incompleteCharacter length] == 0) {
+                completeLength = PLUTF8CompletePrefixLength((const unsigned char *)first->bytes, first->length);
+                [incompleteCharacter appendBytes:first->bytes + completeLength length:first->length - completeLength];
+                output = PLOutputStringWithBytesNoCopy(first->bytes, completeLength, PLOutputChunkAllocator(), &copiedLength);
+                OSAtomicAdd64Barrier((int64_t)copiedLength, &copiedByteCount);
+                goto exit;
+        }
+        
+        pending = malloc(pendingLength);
+        memcpy(pending, [incompleteCharacter bytes], [incompleteCharacter length]);
+        completeLength = [incompleteCharacter length];
+        [incompleteCharacter setLength:0];
+        while (first != NULL) {
+                next = first->previous;
+                memcpy(pending + completeLength, first->bytes, first->length);
+                completeLength += first->length;
+                free(first);
+                first = next;
+        }
+        OSAtomicAdd64Barrier((int64_t)pendingLength, &copiedByteCount);
+        
+        completeLength = PLUTF8CompletePrefixLength((const unsigned char *)pending, pendingLength);
+        [incompleteCharacter appendBytes:pending + completeLength length:pendingLength - completeLength];
+        output = PLOutputStringWithBytesNoCopy(pending, completeLength, kCFAllocatorMalloc, &copiedLength);
+        OSAtomicAdd64Barrier((int64_t)copiedLength, &copiedByteCount);
+exit:
+        return output;
+}
+
+#pragma mark Copy Statistics
+
+-(void)resetCopyStatistics
+{
+        int64_t count;
+        do {
+                count = appendedByteCount;
+        } while (!OSAtomicCompareAndSwap64Barrier(count, 0, &appendedByteCount));
+        do {
+                count = copiedByteCount;
+        } while (!OSAtomicCompareAndSwap64Barrier(count, 0, &copiedByteCount));
+}
+
+@end
@@ -0,0 +1,55 @@
+/**
+ * \file PLInterpreterPythonModule.h
+ * \brief Liasis Python IDE interpreter Python module
+ *
+ * \details This file contains the interface for the native Python module used
+ *          by the interpreter. The module exposes the interpreter output sink
+ *          and other controller services to Python code running in the
+ *          interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+
+/**
+ * \brief The name of the native Python module used by the interpreter.
+ */
+extern const char * const PLInterpreterPythonModuleName;
+
+/**
+ * \brief Create the native interpreter module and add it to sys.modules.
+ *
+ * \details The module provides a 'write' function appending its string
+ *          argument to the shared PLInterpreterOutputSink, and functions
+ *          setting breakpoints and running code with the shared
+ *          PLInterpreterDebugger or a PLInterpreterLineProfiler, and
+ *          editing the shared PLInterpreterWatchList. Calling this
+ *          function more than once returns the module created by the first
+ *          call.
+ *
+ * \return A borrowed reference to the module, or NULL if it could not be
+ *         created.
+ */
+PyObject * PLInterpreterPythonModuleInitialize(void);
@@ -0,0 +1,384 @@
+/**
+ * \file PLInterpreterPythonModule.m
+ * \brief Liasis Python IDE interpreter Python module
+ *
+ * \details This file contains the implementation for the native Python module
+ *          used by the interpreter. The module exposes the interpreter output
+ *          sink and other controller services to Python code running in the
+ *          interpreter.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterPythonModule.h"
+#import "PLInterpreterOutputSink.h"
+#import "PLInterpreterDebugger.h"
+#import "PLInterpreterLineProfiler.h"
+#import "PLInterpreterWatchList.h"
+#import "PLInterpreterArraySummary.h"
+#import "PLInterpreterTable.h"
+#import "PLInterpreterTableWindowController.h"
+#import "PLInterpreterController.h"
+
+const char * const PLInterpreterPythonModuleName = "_liasis_interpreter";
+
+#pragma mark Module Functions
+
+/**
+ * \brief Append a string to the shared interpreter output sink.
+ *
+ * \details The bytes of str arguments are copied directly into the sink
+ *          without an intermediate buffer. When Python stores unicode as
+ *          UTF-16, unicode arguments are encoded into the sink directly from
+ *          the Python buffer, otherwise they are encoded as UTF-8 first. The
+ *          sink does not take a lock, so background threads writing
+ *          concurrently only contend for the global interpreter lock.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the string to write.
+ *
+ * \return None, or NULL if the argument is not a string.
+ */
+static PyObject * PLInterpreterPythonModuleWrite(PyObject * self, PyObject * args)
+{
+        PyObject * text = NULL;
+        PyObject * encodedText = NULL;
+        if (!PyArg_ParseTuple(args, "O:write", &text))
+                return NULL;
+        if (PyUnicode_Check(text) && sizeof(Py_UNICODE) == sizeof(unichar)) {
+                [[PLInterpreterOutputSink sharedSink] appendCharacters:(const unichar *)PyUnicode_AS_UNICODE(text)
+                                                                length:(NSUInteger)PyUnicode_GET_SIZE(text)];
+                Py_RETURN_NONE;
+        } else if (PyUnicode_Check(text)) {
+                encodedText = PyUnicode_AsUTF8String(text);
+                if (encodedText == NULL)
+                        return NULL;
+                text = encodedText;
+        } else if (!PyString_Check(text)) {
+                PyErr_Format(PyExc_TypeError, "write() argument must be a string, not %.200s", Py_TYPE(text)->tp_name);
+                return NULL;
+        }
+        [[PLInterpreterOutputSink sharedSink] appendBytes:PyString_AS_STRING(text)
+                                                   length:(NSUInteger)PyString_GET_SIZE(text)];
+        Py_XDECREF(encodedText);
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Return the number of bytes appended to and copied by the output
+ *        sink, optionally resetting the counts.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing an optional reset flag.
+ *
+ * \return A tuple of the appended and copied byte counts.
+ */
+static PyObject * PLInterpreterPythonModuleCopyStatistics(PyObject * self, PyObject * args)
+{
+        PLInterpreterOutputSink * sink = [PLInterpreterOutputSink sharedSink];
+        PyObject * statistics;
+        int reset = 0;
+        if (!PyArg_ParseTuple(args, "|i:copy_statistics", &reset))
+                return NULL;
+        statistics = Py_BuildValue("(LL)", (long long)[sink appendedByteCount], (long long)[sink copiedByteCount]);
+        if (reset)
+                [sink resetCopyStatistics];
+        return statistics;
+}
+
+/**
+ * \brief Add a breakpoint to the shared debugger.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing either a code object, or a file
+ *             name and a line number.
+ *
+ * \return None, or NULL if the arguments are invalid.
+ */
+static PyObject * PLInterpreterPythonModuleSetBreakpoint(PyObject * self, PyObject * args)
+{
+        PyObject * code = NULL;
+        const char * path = NULL;
+        int line = 0;
+        if (PyArg_ParseTuple(args, "O!:set_breakpoint", &PyCode_Type, &code)) {
+                [[PLInterpreterDebugger sharedDebugger] addBreakpointInCode:(PyCodeObject *)code];
+                Py_RETURN_NONE;
+        }
+        PyErr_Clear();
+        if (!PyArg_ParseTuple(args, "si:set_breakpoint", &path, &line))
+                return NULL;
+        [[PLInterpreterDebugger sharedDebugger] addBreakpointAtLine:line inFile:[NSString stringWithUTF8String:path]];
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Remove all breakpoints of the shared debugger.
+ *
+ * \param self The module object.
+ *
+ * \param args The empty argument tuple.
+ *
+ * \return None.
+ */
+static PyObject * PLInterpreterPythonModuleClearBreakpoints(PyObject * self, PyObject * args)
+{
+        [[PLInterpreterDebugger sharedDebugger] removeAllBreakpoints];
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Return descriptions of the breakpoints of the shared debugger.
+ *
+ * \param self The module object.
+ *
+ * \param args The empty argument tuple.
+ *
+ * \return A list of strings.
+ */
+static PyObject * PLInterpreterPythonModuleBreakpoints(PyObject * self, PyObject * args)
+{
+        NSArray * descriptions = [[PLInterpreterDebugger sharedDebugger] breakpointDescriptions];
+        PyObject * list = PyList_New(0), * item;
+        for (NSString * description in descriptions) {
+                item = PyString_FromString([description UTF8String]);
+                PyList_Append(list, item);
+                Py_DECREF(item);
+        }
+        return list;
+}
+
+/**
+ * \brief Run a code object with the breakpoints of the shared debugger.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the code object and the globals.
+ *
+ * \return The result of the code, or NULL with an exception set.
+ */
+static PyObject * PLInterpreterPythonModuleDebug(PyObject * self, PyObject * args)
+{
+        PyObject * code = NULL, * globals = NULL;
+        if (!PyArg_ParseTuple(args, "O!O!:debug", &PyCode_Type, &code, &PyDict_Type, &globals))
+                return NULL;
+        return [[PLInterpreterDebugger sharedDebugger] runCode:(PyCodeObject *)code globals:globals];
+}
+
+/**
+ * \brief Run a code object, profiling the lines of selected code objects.
+ *
+ * \details An exception raised by the code is printed, and the statistics
+ *          of the lines run until then are still returned.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the sequence of code objects to
+ *             profile, the code object to run and the globals.
+ *
+ * \return The statistics of the profiled lines, or NULL if the arguments are
+ *         invalid.
+ */
+static PyObject * PLInterpreterPythonModuleLineProfile(PyObject * self, PyObject * args)
+{
+        PyObject * codes = NULL, * code = NULL, * globals = NULL, * result, * statistics;
+        PLInterpreterLineProfiler * profiler;
+        if (!PyArg_ParseTuple(args, "OO!O!:line_profile", &codes, &PyCode_Type, &code, &PyDict_Type, &globals))
+                return NULL;
+        profiler = [[PLInterpreterLineProfiler alloc] initWithCodes:codes];
+        if (profiler == nil)
+                return NULL;
+        result = [profiler runCode:(PyCodeObject *)code globals:globals];
+        if (result == NULL)
+                PyErr_Print();
+        Py_XDECREF(result);
+        statistics = [profiler statistics];
+        [profiler release];
+        return statistics;
+}
+
+/**
+ * \brief Add a watch expression to the shared watch list.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the expression.
+ *
+ * \return None, or NULL if the expression does not compile.
+ */
+static PyObject * PLInterpreterPythonModuleWatch(PyObject * self, PyObject * args)
+{
+        const char * expression = NULL;
+        if (!PyArg_ParseTuple(args, "s:watch", &expression))
+                return NULL;
+        if (![[PLInterpreterWatchList sharedWatchList] addExpression:[NSString stringWithUTF8String:expression]])
+                return NULL;
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Remove a watch expression, or all watch expressions, from the shared
+ *        watch list.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the optional expression.
+ *
+ * \return None.
+ */
+static PyObject * PLInterpreterPythonModuleUnwatch(PyObject * self, PyObject * args)
+{
+        const char * expression = NULL;
+        if (!PyArg_ParseTuple(args, "|s:unwatch", &expression))
+                return NULL;
+        if (expression == NULL)
+                [[PLInterpreterWatchList sharedWatchList] removeAllExpressions];
+        else
+                [[PLInterpreterWatchList sharedWatchList] removeExpression:[NSString stringWithUTF8String:expression]];
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Summarize the values of an array in the background.
+ *
+ * \details The summary is written to the shared output sink when it is
+ *          complete, and is displayed above the prompt.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the array and its name.
+ *
+ * \return None, or NULL if the array has no contiguous buffer of numbers.
+ */
+static PyObject * PLInterpreterPythonModuleSummarize(PyObject * self, PyObject * args)
+{
+        PyObject * object = NULL;
+        const char * name = NULL;
+        if (!PyArg_ParseTuple(args, "Os:summarize", &object, &name))
+                return NULL;
+        if (![PLInterpreterArraySummary summarizeObject:object
+                                                   name:[NSString stringWithUTF8String:name]
+                                                 toSink:[PLInterpreterOutputSink sharedSink]])
+                return NULL;
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Open a table viewer of a DataFrame or an array.
+ *
+ * \param self The module object.
+ *
+ * \param args The argument tuple, containing the object and the title of the
+ *             viewer.
+ *
+ * \return None, or NULL if the object is not a table.
+ */
+static PyObject * PLInterpreterPythonModuleView(PyObject * self, PyObject * args)
+{
+        PyObject * object = NULL;
+        const char * title = NULL;
+        PLInterpreterTable * table;
+        if (!PyArg_ParseTuple(args, "Os:view", &object, &title))
+                return NULL;
+        table = [[PLInterpreterTable alloc] initWithObject:object];
+        if (table == nil)
+                return NULL;
+        [PLInterpreterTableWindowController showTable:table title:[NSString stringWithUTF8String:title]];
+        [table release];
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Display the output of the running magic command and check for the
+ *        interrupt key.
+ *
+ * \details Only the main thread, which runs magic commands, displays output.
+ *
+ * \param self The module object.
+ *
+ * \param args Unused.
+ *
+ * \return True if the interrupt key was pressed, otherwise False.
+ */
+static PyObject * PLInterpreterPythonModuleDisplayProgress(PyObject * self, PyObject * args)
+{
+        if (![NSThread isMainThread])
+                Py_RETURN_FALSE;
+        return PyBool_FromLong([PLInterpreterController displayProgressOfRunningCommand]);
+}
+
+/**
+ * \brief The method table of the native interpreter module.
+ */
+static PyMethodDef PLInterpreterPythonModuleMethods[] = {
+        {"write", PLInterpreterPythonModuleWrite, METH_VARARGS,
+         "write(str) -> None\n\nAppend a string to the interpreter output."},
+        {"copy_statistics", PLInterpreterPythonModuleCopyStatistics, METH_VARARGS,
+         "copy_statistics(reset=False) -> (appended, copied)\n\n"
+         "Return the number of bytes of output appended to the output sink and\n"
+         "the number of bytes it copied, optionally resetting the counts."},
+        {"set_breakpoint", PLInterpreterPythonModuleSetBreakpoint, METH_VARARGS,
+         "set_breakpoint(code) or set_breakpoint(filename, line) -> None\n\n"
+         "Break at the first line of a code object, or at a line of a file."},
+        {"clear_breakpoints", PLInterpreterPythonModuleClearBreakpoints, METH_NOARGS,
+         "clear_breakpoints() -> None\n\nRemove all breakpoints."},
+        {"breakpoints", PLInterpreterPythonModuleBreakpoints, METH_NOARGS,
+         "breakpoints() -> list\n\nReturn descriptions of the breakpoints."},
+        {"debug", PLInterpreterPythonModuleDebug, METH_VARARGS,
+         "debug(code, globals) -> object\n\n"
+         "Run a code object with the breakpoints, pausing in the interpreter."},
+        {"line_profile", PLInterpreterPythonModuleLineProfile, METH_VARARGS,
+         "line_profile(codes, code, globals) -> [(code, [(line, hits, seconds)])]\n\n"
+         "Run a code object, measuring the lines of the profiled code objects."},
+        {"watch", PLInterpreterPythonModuleWatch, METH_VARARGS,
+         "watch(expression) -> None\n\nAdd an expression to the watch panel."},
+        {"unwatch", PLInterpreterPythonModuleUnwatch, METH_VARARGS,
+         "unwatch([expression]) -> None\n\n"
+         "Remove an expression, or all expressions, from the watch panel."},
+        {"summarize", PLInterpreterPythonModuleSummarize, METH_VARARGS,
+         "summarize(array, name) -> None\n\n"
+         "Write the minimum, maximum, mean and NaN count of an array to the\n"
+         "interpreter output once they are computed in the background."},
+        {"view", PLInterpreterPythonModuleView, METH_VARARGS,
+         "view(table, title) -> None\n\n"
+         "Open a DataFrame, a Series or an array in a table viewer."},
+        {"display_progress", PLInterpreterPythonModuleDisplayProgress, METH_NOARGS,
+         "display_progress() -> bool\n\n"
+         "Display the output of the running magic command, and return whether\n"
+         "the interrupt key was pressed."},
+        {NULL, NULL, 0, NULL}
+};
+
+#pragma mark Module Initialization
+
+PyObject * PLInterpreterPythonModuleInitialize(void)
+{
+        static PyObject * module = NULL;
+        if (module == NULL)
+                module = Py_InitModule3(PLInterpreterPythonModuleName,
+                                        PLInterpreterPythonModuleMethods,
+                                        "Native services of the Liasis interpreter.");
+        return module;
+}
@@ -0,0 +1,169 @@
+/**
+ * \file PLInterpreterTable.h
+ * \brief Liasis Python IDE interpreter table
+ *
+ * \details This file contains the interface of a table of cells read a page at
+ *          a time from a DataFrame or an array.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+
+/**
+ * \brief The maximum number of columns of a table.
+ */
+extern const NSUInteger PLInterpreterTableMaximumColumnCount;
+
+/**
+ * \class PLInterpreterTable \headerfile \headerfile
+ * \brief The cells of a DataFrame, a Series or an array, read a page at a
+ *        time.
+ *
+ * \details Cells are read from the Python object by the table helpers of the
+ *          bundled liasis_introspection module in pages of rows and columns,
+ *          formatted in Python, and the recent pages are cached. Only the
+ *          pages containing requested cells are ever read, so that the cost of
+ *          displaying a table does not depend on its size. Column statistics
+ *          are computed when first requested, and kept.
+ *
+ *          All methods call into Python, and must be called with the global
+ *          interpreter lock held.
+ */
+@interface PLInterpreterTable : NSObject {
+        /**
+         * \brief The Python object of the table.
+         */
+        PyObject * object;
+        
+        /**
+         * \brief The number of rows.
+         */
+        NSUInteger rowCount;
+        
+        /**
+         * \brief The number of columns of the object, which may be more than
+         *        the number of column names.
+         */
+        NSUInteger columnCount;
+        
+        /**
+         * \brief The names of the displayed columns.
+         */
+        NSArray * columnNames;
+        
+        /**
+         * \brief The recent pages, each an array of the row labels and the
+         *        rows of cells, keyed by their first row and column.
+         */
+        NSCache * pageCache;
+        
+        /**
+         * \brief The page of the last requested cell.
+         */
+        NSArray * lastPage;
+        
+        /**
+         * \brief The first row of the last page.
+         */
+        NSUInteger lastPageRow;
+        
+        /**
+         * \brief The first column of the last page.
+         */
+        NSUInteger lastPageColumn;
+        
+        /**
+         * \brief The statistics of the columns computed so far, keyed by the
+         *        column index.
+         */
+        NSMutableDictionary * columnStatistics;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The number of rows.
+ */
+@property(readonly) NSUInteger rowCount;
+
+/**
+ * \brief The number of columns of the object, which may be more than the
+ *        number of displayed columns.
+ */
+@property(readonly) NSUInteger columnCount;
+
+/**
+ * \brief The names of the displayed columns, at most
+ *        PLInterpreterTableMaximumColumnCount.
+ */
+@property(readonly) NSArray * columnNames;
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize a table of a Python object.
+ *
+ * \param anObject A DataFrame, a Series or an array of one or two dimensions.
+ *
+ * \return An initialized PLInterpreterTable object, or nil with a Python
+ *         exception set if the object is not a table.
+ */
+-(id)initWithObject:(PyObject *)anObject;
+
+#pragma mark Reading Cells
+
+/**
+ * \brief Return the label of a row.
+ *
+ * \param row The index of the row.
+ *
+ * \return The label, or an empty string if it cannot be read.
+ */
+-(NSString *)labelOfRow:(NSUInteger)row;
+
+/**
+ * \brief Return a formatted cell.
+ *
+ * \param row The index of the row.
+ *
+ * \param column The index of the column.
+ *
+ * \return The formatted cell, or an empty string if it cannot be read.
+ */
+-(NSString *)stringValueAtRow:(NSUInteger)row column:(NSUInteger)column;
+
+/**
+ * \brief Return a description of the values of a column.
+ *
+ * \details The statistics are computed over the whole column the first time
+ *          they are requested.
+ *
+ * \param column The index of the column.
+ *
+ * \return The description, or nil if it cannot be computed.
+ */
+-(NSString *)statisticsOfColumn:(NSUInteger)column;
+
+@end
@@ -0,0 +1,230 @@
+/**
+ * \file PLInterpreterTable.m
+ * \brief Liasis Python IDE interpreter table
+ *
+ * \details This file contains the implementation of a table of cells read a
+ *          page at a time from a DataFrame or an array.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterTable.h"
+
+const NSUInteger PLInterpreterTableMaximumColumnCount = 1000;
+
+/**
+ * \brief The name of the bundled module providing the table helpers.
+ */
+static const char * PLInterpreterTableModuleName = "liasis_introspection";
+
+/**
+ * \brief The number of rows of a page.
+ */
+static const NSUInteger PLInterpreterTablePageRowCount = 128;
+
+/**
+ * \brief The number of columns of a page.
+ */
+static const NSUInteger PLInterpreterTablePageColumnCount = 16;
+
+/**
+ * \brief The maximum number of cached pages.
+ */
+static const NSUInteger PLInterpreterTablePageCacheCount = 256;
+
+/**
+ * \brief Convert a Python string returned by a table helper.
+ *
+ * \param string The Python string.
+ *
+ * \return The string, or an empty string if it is not a valid UTF-8 string.
+ */
+static NSString * PLInterpreterTableString(PyObject * string)
+{
+        NSString * value = nil;
+        if (string != NULL && PyString_Check(string))
+                value = [NSString stringWithUTF8String:PyString_AS_STRING(string)];
+        return (value == nil) ? @"" : value;
+}
+
+@implementation PLInterpreterTable
+
+@synthesize rowCount;
+@synthesize columnCount;
+@synthesize columnNames;
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithObject:(PyObject *)anObject
+{
+        PyObject * module, * shape = NULL, * names;
+        NSMutableArray * newColumnNames;
+        Py_ssize_t rows = 0, columns = 0, i;
+        self = [super init];
+        if (self == nil)
+                return nil;
+        module = PyImport_ImportModule(PLInterpreterTableModuleName);
+        if (module != NULL)
+                shape = PyObject_CallMethod(module, "table_shape", "On", anObject, (Py_ssize_t)PLInterpreterTableMaximumColumnCount);
+        Py_XDECREF(module);
+        if (shape == Py_None)
+                PyErr_Format(PyExc_TypeError, "cannot view %.200s objects as a table", Py_TYPE(anObject)->tp_name);
+        if (shape == NULL || shape == Py_None || !PyArg_ParseTuple(shape, "nnO!", &rows, &columns, &PyList_Type, &names)) {
+                Py_XDECREF(shape);
+                [self release];
+                return nil;
+        }
+        rowCount = (NSUInteger)rows;
+        columnCount = (NSUInteger)columns;
+        newColumnNames = [NSMutableArray arrayWithCapacity:(NSUInteger)PyList_GET_SIZE(names)];
+        for (i = 0; i < PyList_GET_SIZE(names); i++)
+                [newColumnNames addObject:PLInterpreterTableString(PyList_GET_ITEM(names, i))];
+        Py_DECREF(shape);
+        object = anObject;
+        Py_INCREF(object);
+        columnNames = [newColumnNames copy];
+        pageCache = [[NSCache alloc] init];
+        [pageCache setCountLimit:PLInterpreterTablePageCacheCount];
+        columnStatistics = [[NSMutableDictionary alloc] init];
+        return self;
+}
+
+/**
+ * \brief Release the object and the cached pages.
+ */
+-(void)dealloc
+{
+        Py_XDECREF(object);
+        [columnNames release];
+        [pageCache release];
+        [lastPage release];
+        [columnStatistics release];
+        [super dealloc];
+}
+
+#pragma mark Reading Cells
+
+/**
+ * \brief Return the page containing a cell, reading it if it is not cached.
+ *
+ * \details The page of the last requested cell is checked first, since the
+ *          cells of a visible region are requested one after the other and
+ *          mostly belong to the same page.
+ *
+ * \param row The index of the row of the cell.
+ *
+ * \param column The index of the column of the cell.
+ *
+ * \return The page, an array of the row labels and the rows of cells, or nil
+ *         if it cannot be read.
+ */
+-(NSArray *)pageContainingRow:(NSUInteger)row column:(NSUInteger)column
+{
+        NSUInteger pageRow = row - row % PLInterpreterTablePageRowCount;
+        NSUInteger pageColumn = column - column % PLInterpreterTablePageColumnCount;
+        PyObject * module, * result = NULL, * labels, * rows, * cells;
+        NSMutableArray * pageLabels, * pageRows, * pageCells;
+        NSString * key;
+        NSArray * page = nil;
+        Py_ssize_t i, j;
+        
+        if (lastPage != nil && lastPageRow == pageRow && lastPageColumn == pageColumn)
+                return lastPage;
+        key = [NSString stringWithFormat:@"%lu:%lu", (unsigned long)pageRow, (unsigned long)pageColumn];
+        page = [pageCache objectForKey:key];
+        if (page != nil)
+                goto exit;
+        module = PyImport_ImportModule(PLInterpreterTableModuleName);
+        if (module != NULL)
+                result = PyObject_CallMethod(module, "table_page", "Onnnn", object,
+                                             (Py_ssize_t)pageRow, (Py_ssize_t)PLInterpreterTablePageRowCount,
+                                             (Py_ssize_t)pageColumn, (Py_ssize_t)PLInterpreterTablePageColumnCount);
+        Py_XDECREF(module);
+        if (result == NULL || !PyArg_ParseTuple(result, "O!O!", &PyList_Type, &labels, &PyList_Type, &rows)) {
+                PyErr_Clear();
+                goto exit;
+        }
+        pageLabels = [NSMutableArray arrayWithCapacity:(NSUInteger)PyList_GET_SIZE(labels)];
+        for (i = 0; i < PyList_GET_SIZE(labels); i++)
+                [pageLabels addObject:PLInterpreterTableString(PyList_GET_ITEM(labels, i))];
+        pageRows = [NSMutableArray arrayWithCapacity:(NSUInteger)PyList_GET_SIZE(rows)];
+        for (i = 0; i < PyList_GET_SIZE(rows); i++) {
+                cells = PyList_GET_ITEM(rows, i);
+                pageCells = [NSMutableArray array];
+                for (j = 0; PyList_Check(cells) && j < PyList_GET_SIZE(cells); j++)
+                        [pageCells addObject:PLInterpreterTableString(PyList_GET_ITEM(cells, j))];
+                [pageRows addObject:pageCells];
+        }
+        page = [NSArray arrayWithObjects:pageLabels, pageRows, nil];
+        [pageCache setObject:page forKey:key];
+exit:
+        Py_XDECREF(result);
+        if (page != nil) {
+                [lastPage release];
+                lastPage = [page retain];
+                lastPageRow = pageRow;
+                lastPageColumn = pageColumn;
+        }
+        return page;
+}
+
+-(NSString *)labelOfRow:(NSUInteger)row
+{
+        NSArray * labels = [[self pageContainingRow:row column:0] objectAtIndex:0];
+        NSUInteger index = row % PLInterpreterTablePageRowCount;
+        return (index < [labels count]) ? [labels objectAtIndex:index] : @"";
+}
+
+-(NSString *)stringValueAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+        NSArray * rows = [[self pageContainingRow:row column:column] objectAtIndex:1], * cells;
+        NSUInteger index = row % PLInterpreterTablePageRowCount;
+        if (index >= [rows count])
+                return @"";
+        cells = [rows objectAtIndex:index];
+        index = column % PLInterpreterTablePageColumnCount;
+        return (index < [cells count]) ? [cells objectAtIndex:index] : @"";
+}
+
+-(NSString *)statisticsOfColumn:(NSUInteger)column
+{
+        NSNumber * key = [NSNumber numberWithUnsignedInteger:column];
+        NSString * statistics = [columnStatistics objectForKey:key];
+        PyObject * module, * result = NULL;
+        if (statistics != nil)
+                return statistics;
+        module = PyImport_ImportModule(PLInterpreterTableModuleName);
+        if (module != NULL)
+                result = PyObject_CallMethod(module, "column_statistics", "On", object, (Py_ssize_t)column);
+        Py_XDECREF(module);
+        if (result == NULL) {
+                PyErr_Clear();
+                return nil;
+        }
+        statistics = PLInterpreterTableString(result);
+        Py_DECREF(result);
+        [columnStatistics setObject:statistics forKey:key];
+        return statistics;
+}
+
+@end
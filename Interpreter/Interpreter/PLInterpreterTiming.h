@@ -0,0 +1,46 @@
+/**
+ * \file PLInterpreterTiming.h
+ * \brief Liasis Python IDE interpreter timing
+ *
+ * \details This file contains the functions used to measure the time taken by
+ *          the interpreter, for example during startup.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <mach/mach_time.h>
+
+/**
+ * \brief Return the time elapsed since an absolute time, in milliseconds.
+ *
+ * \param start A time returned by mach_absolute_time().
+ *
+ * \return The number of milliseconds elapsed since start.
+ */
+static inline double PLInterpreterMillisecondsSince(uint64_t start)
+{
+        static mach_timebase_info_data_t timebase;
+        if (timebase.denom == 0)
+                mach_timebase_info(&timebase);
+        return (double)(mach_absolute_time() - start) * timebase.numer / timebase.denom / 1e6;
+}
@@ -0,0 +1,137 @@
+/**
+ * \file PLInterpreterTranscriptExporter.h
+ * \brief Liasis Python IDE interpreter transcript exporter
+ *
+ * \details This file contains the public interface for exporting the
+ *          interpreter transcript as a Python script or a notebook.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Cocoa/Cocoa.h>
+#import "PLInterpreterTranscriptIndex.h"
+
+/**
+ * \brief The formats the transcript can be exported to.
+ */
+typedef enum {
+        /**
+         * \brief A Python script with the inputs as code and the outputs as
+         *        comments. Magic and shell commands are commented too.
+         */
+        PLInterpreterTranscriptExportPython,
+        
+        /**
+         * \brief A Jupyter notebook with a code cell for each command and its
+         *        output as a stream output.
+         */
+        PLInterpreterTranscriptExportNotebook
+} PLInterpreterTranscriptExportFormat;
+
+/**
+ * \class PLInterpreterTranscriptExporter \headerfile \headerfile
+ * \brief Export the commands of the interpreter transcript to a file.
+ *
+ * \details The exporter walks the commands of the transcript index and streams
+ *          the input and output of each command to the file through a fixed
+ *          size buffer, converting and escaping the transcript a bounded
+ *          number of characters at a time. Memory use therefore does not grow
+ *          with the size of the transcript. Folded lines are written expanded.
+ */
+@interface PLInterpreterTranscriptExporter : NSObject {
+        /**
+         * \brief The text storage of the interpreter transcript.
+         */
+        NSTextStorage * textStorage;
+        
+        /**
+         * \brief The index of the commands of the transcript.
+         */
+        PLInterpreterTranscriptIndex * transcriptIndex;
+        
+        /**
+         * \brief The file descriptor being written, or -1.
+         */
+        int fileDescriptor;
+        
+        /**
+         * \brief The buffer of bytes waiting to be written.
+         */
+        char * buffer;
+        
+        /**
+         * \brief The number of bytes in buffer.
+         */
+        NSUInteger bufferLength;
+        
+        /**
+         * \brief The error number of the first failed write, or zero.
+         */
+        int writeError;
+        
+        /**
+         * \brief Whether or not the next output character starts a line. Used
+         *        to comment the output of Python scripts.
+         */
+        BOOL atLineStart;
+}
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize an exporter of a transcript.
+ *
+ * \param aTextStorage The text storage of the interpreter transcript.
+ *
+ * \param anIndex The index of the commands of the transcript.
+ *
+ * \return An initialized PLInterpreterTranscriptExporter object.
+ */
+-(id)initWithTextStorage:(NSTextStorage *)aTextStorage transcriptIndex:(PLInterpreterTranscriptIndex *)anIndex;
+
+#pragma mark Exporting
+
+/**
+ * \brief Return the export format matching the extension of a path.
+ *
+ * \param path The path of the exported file.
+ *
+ * \return PLInterpreterTranscriptExportNotebook for the ipynb extension,
+ *         otherwise PLInterpreterTranscriptExportPython.
+ */
++(PLInterpreterTranscriptExportFormat)formatForPath:(NSString *)path;
+
+/**
+ * \brief Write the commands of the transcript to a file.
+ *
+ * \param path The path of the file, which is replaced if it exists.
+ *
+ * \param format The format of the file.
+ *
+ * \param error On failure, set to an NSError describing the failure.
+ *
+ * \return YES if the file was written, otherwise NO.
+ */
+-(BOOL)writeToPath:(NSString *)path format:(PLInterpreterTranscriptExportFormat)format error:(NSError **)error;
+
+@end
@@ -0,0 +1,382 @@
+/**
+ * \file PLInterpreterTranscriptExporter.m
+ * \brief Liasis Python IDE interpreter transcript exporter
+ *
+ * \details This file contains the implementation for exporting the interpreter
+ *          transcript as a Python script or a notebook.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <fcntl.h>
+#import <unistd.h>
+#import "PLInterpreterTranscriptExporter.h"
+#import "PLInterpreterFoldedText.h"
+
+/**
+ * \brief The size of the write buffer, in bytes.
+ */
+#define PLInterpreterTranscriptExporterBufferSize 65536
+
+/**
+ * \brief The number of transcript characters converted at a time.
+ */
+#define PLInterpreterTranscriptExporterChunkLength 4096
+
+/**
+ * \brief The ways characters are transformed before they are written.
+ */
+typedef enum {
+        /**
+         * \brief Characters are written unchanged.
+         */
+        PLInterpreterTranscriptExporterRaw,
+        
+        /**
+         * \brief Each line is prefixed with a Python comment marker.
+         */
+        PLInterpreterTranscriptExporterComment,
+        
+        /**
+         * \brief Characters are escaped for a JSON string.
+         */
+        PLInterpreterTranscriptExporterJSON
+} PLInterpreterTranscriptExporterTransform;
+
+#pragma mark -
+
+@implementation PLInterpreterTranscriptExporter
+
+#pragma mark Initialization and Deallocation
+
+-(id)initWithTextStorage:(NSTextStorage *)aTextStorage transcriptIndex:(PLInterpreterTranscriptIndex *)anIndex
+{
+        self = [super init];
+        if (self) {
+                textStorage = [aTextStorage retain];
+                transcriptIndex = [anIndex retain];
+                fileDescriptor = -1;
+                buffer = malloc(PLInterpreterTranscriptExporterBufferSize);
+                bufferLength = 0;
+                writeError = 0;
+        }
+        return self;
+}
+
+/**
+ * \brief Release the transcript and free the write buffer.
+ */
+-(void)dealloc
+{
+        [textStorage release];
+        [transcriptIndex release];
+        free(buffer);
+        [super dealloc];
+}
+
+#pragma mark Writing Bytes
+
+/**
+ * \brief Write the buffered bytes to the file.
+ */
+-(void)flushBuffer
+{
+        const char * bytes = buffer;
+        ssize_t written;
+        while (bufferLength > 0 && writeError == 0) {
+                written = write(fileDescriptor, bytes, bufferLength);
+                if (written < 0) {
+                        if (errno != EINTR)
+                                writeError = errno;
+                        continue;
+                }
+                bytes += written;
+                bufferLength -= (NSUInteger)written;
+        }
+        bufferLength = 0;
+}
+
+/**
+ * \brief Write a string through the buffer, encoded as UTF-8.
+ *
+ * \param string The string, which may be of any length.
+ */
+-(void)writeString:(NSString *)string
+{
+        NSRange remaining = NSMakeRange(0, [string length]);
+        NSUInteger used;
+        while (remaining.length > 0 && writeError == 0) {
+                if (PLInterpreterTranscriptExporterBufferSize - bufferLength < 4)
+                        [self flushBuffer];
+                [string getBytes:buffer + bufferLength
+                       maxLength:PLInterpreterTranscriptExporterBufferSize - bufferLength
+                      usedLength:&used
+                        encoding:NSUTF8StringEncoding
+                         options:NSStringEncodingConversionAllowLossy
+                           range:remaining
+                  remainingRange:&remaining];
+                bufferLength += used;
+        }
+}
+
+#pragma mark Writing Characters
+
+/**
+ * \brief Transform a bounded string and write it.
+ *
+ * \param string A string of at most PLInterpreterTranscriptExporterChunkLength
+ *               characters.
+ *
+ * \param transform The transform of the characters.
+ */
+-(void)writeChunk:(NSString *)string transform:(PLInterpreterTranscriptExporterTransform)transform
+{
+        NSMutableString * transformed;
+        NSUInteger i, length = [string length];
+        unichar character;
+        
+        if (transform == PLInterpreterTranscriptExporterRaw) {
+                [self writeString:string];
+                return;
+        }
+        transformed = [[NSMutableString alloc] initWithCapacity:length + length/4];
+        for (i = 0; i < length; i++) {
+                character = [string characterAtIndex:i];
+                if (transform == PLInterpreterTranscriptExporterComment) {
+                        if (atLineStart)
+                                [transformed appendString:@"# "];
+                        [transformed appendFormat:@"%C", character];
+                        atLineStart = (character == '\n');
+                        continue;
+                }
+                switch (character) {
+                        case '"':
+                                [transformed appendString:@"\\\""];
+                                break;
+                        case '\\':
+                                [transformed appendString:@"\\\\"];
+                                break;
+                        case '\n':
+                                [transformed appendString:@"\\n"];
+                                break;
+                        case '\r':
+                                [transformed appendString:@"\\r"];
+                                break;
+                        case '\t':
+                                [transformed appendString:@"\\t"];
+                                break;
+                        default:
+                                if (character < 0x20)
+                                        [transformed appendFormat:@"\\u%04x", character];
+                                else
+                                        [transformed appendFormat:@"%C", character];
+                                break;
+                }
+        }
+        [self writeString:transformed];
+        [transformed release];
+}
+
+/**
+ * \brief Write a range of a string a bounded number of characters at a time.
+ *
+ * \param string The string.
+ *
+ * \param aRange The range of the characters to write.
+ *
+ * \param transform The transform of the characters.
+ */
+-(void)writeCharactersOfString:(NSString *)string range:(NSRange)aRange transform:(PLInterpreterTranscriptExporterTransform)transform
+{
+        NSUInteger location = aRange.location, length;
+        NSAutoreleasePool * pool;
+        while (location < NSMaxRange(aRange) && writeError == 0) {
+                pool = [[NSAutoreleasePool alloc] init];
+                length = MIN(PLInterpreterTranscriptExporterChunkLength, NSMaxRange(aRange) - location);
+                /* Keep surrogate pairs in the same chunk. */
+                if (length > 1 && location + length < NSMaxRange(aRange) && CFStringIsSurrogateHighCharacter([string characterAtIndex:location + length - 1]))
+                        length--;
+                [self writeChunk:[string substringWithRange:NSMakeRange(location, length)] transform:transform];
+                [pool drain];
+                location += length;
+        }
+}
+
+/**
+ * \brief Write a range of the transcript, expanding folded lines.
+ *
+ * \param aRange The range of the transcript.
+ *
+ * \param transform The transform of the characters.
+ */
+-(void)writeTranscriptRange:(NSRange)aRange transform:(PLInterpreterTranscriptExporterTransform)transform
+{
+        NSString * transcript = [textStorage string];
+        NSUInteger location = aRange.location;
+        NSRange effectiveRange;
+        PLInterpreterFoldedText * foldedText;
+        
+        while (location < NSMaxRange(aRange) && writeError == 0) {
+                foldedText = [textStorage attribute:PLInterpreterFoldedTextAttributeName
+                                            atIndex:location
+                              longestEffectiveRange:&effectiveRange
+                                            inRange:aRange];
+                if (foldedText != nil)
+                        [self writeCharactersOfString:[foldedText text] range:NSMakeRange(0, [[foldedText text] length]) transform:transform];
+                else
+                        [self writeCharactersOfString:transcript range:effectiveRange transform:transform];
+                location = NSMaxRange(effectiveRange);
+        }
+}
+
+#pragma mark Exporting
+
++(PLInterpreterTranscriptExportFormat)formatForPath:(NSString *)path
+{
+        if ([[[path pathExtension] lowercaseString] isEqualToString:@"ipynb"])
+                return PLInterpreterTranscriptExportNotebook;
+        return PLInterpreterTranscriptExportPython;
+}
+
+/**
+ * \brief Write the input of a command without its continuation prompts.
+ *
+ * \param command The command.
+ *
+ * \param transform The transform of the characters.
+ */
+-(void)writeInputOfCommand:(PLInterpreterTranscriptCommand)command transform:(PLInterpreterTranscriptExporterTransform)transform
+{
+        NSString * input = [[textStorage string] substringWithRange:command.inputRange];
+        input = [input stringByReplacingOccurrencesOfString:@"\n... " withString:@"\n"];
+        [self writeCharactersOfString:input range:NSMakeRange(0, [input length]) transform:transform];
+}
+
+/**
+ * \brief Return whether or not a command is a magic or shell command, which
+ *        is not valid Python.
+ *
+ * \param command The command.
+ *
+ * \return YES if the input of the command starts with % or !.
+ */
+-(BOOL)isMagicOrShellCommand:(PLInterpreterTranscriptCommand)command
+{
+        unichar first;
+        if (command.inputRange.length == 0)
+                return NO;
+        first = [[textStorage string] characterAtIndex:command.inputRange.location];
+        return (first == '%' || first == '!');
+}
+
+/**
+ * \brief Write the commands of the transcript as a Python script.
+ *
+ * \details Magic and shell commands are written as comments, like the outputs,
+ *          so that the script still runs.
+ */
+-(void)writePython
+{
+        PLInterpreterTranscriptCommand command;
+        NSUInteger i;
+        [self writeString:@"# Exported from the Liasis Python interpreter.\n"];
+        for (i = 0; i < [transcriptIndex commandCount] && writeError == 0; i++) {
+                command = [transcriptIndex commandAtIndex:i];
+                [self writeString:@"\n"];
+                if ([self isMagicOrShellCommand:command]) {
+                        atLineStart = YES;
+                        [self writeInputOfCommand:command transform:PLInterpreterTranscriptExporterComment];
+                } else {
+                        [self writeInputOfCommand:command transform:PLInterpreterTranscriptExporterRaw];
+                }
+                [self writeString:@"\n"];
+                if (command.outputRange.length == 0)
+                        continue;
+                atLineStart = YES;
+                [self writeTranscriptRange:command.outputRange transform:PLInterpreterTranscriptExporterComment];
+                if (!atLineStart)
+                        [self writeString:@"\n"];
+        }
+}
+
+/**
+ * \brief Write the commands of the transcript as a Jupyter notebook.
+ */
+-(void)writeNotebook
+{
+        PLInterpreterTranscriptCommand command;
+        NSUInteger i;
+        [self writeString:@"{\n \"cells\": ["];
+        for (i = 0; i < [transcriptIndex commandCount] && writeError == 0; i++) {
+                command = [transcriptIndex commandAtIndex:i];
+                [self writeString:[NSString stringWithFormat:@"%@\n  {\n   \"cell_type\": \"code\",\n   \"execution_count\": %lu,\n   \"metadata\": {},\n   \"source\": \"",
+                                   (i > 0) ? @"," : @"", (unsigned long)i + 1]];
+                [self writeInputOfCommand:command transform:PLInterpreterTranscriptExporterJSON];
+                [self writeString:@"\",\n   \"outputs\": ["];
+                if (command.outputRange.length > 0) {
+                        [self writeString:@"\n    {\n     \"name\": \"stdout\",\n     \"output_type\": \"stream\",\n     \"text\": \""];
+                        [self writeTranscriptRange:command.outputRange transform:PLInterpreterTranscriptExporterJSON];
+                        [self writeString:@"\"\n    }\n   "];
+                }
+                [self writeString:@"]\n  }"];
+        }
+        [self writeString:@"\n ],\n"
+                          @" \"metadata\": {\n"
+                          @"  \"kernelspec\": {\"display_name\": \"Python 2\", \"language\": \"python\", \"name\": \"python2\"},\n"
+                          @"  \"language_info\": {\"name\": \"python\"}\n"
+                          @" },\n"
+                          @" \"nbformat\": 4,\n"
+                          @" \"nbformat_minor\": 0\n"
+                          @"}\n"];
+}
+
+-(BOOL)writeToPath:(NSString *)path format:(PLInterpreterTranscriptExportFormat)format error:(NSError **)error
+{
+        BOOL success = YES;
+        writeError = 0;
+        fileDescriptor = open([path fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor < 0) {
+                writeError = errno;
+                goto exit;
+        }
+        bufferLength = 0;
+        if (format == PLInterpreterTranscriptExportNotebook)
+                [self writeNotebook];
+        else
+                [self writePython];
+        [self flushBuffer];
+        if (close(fileDescriptor) != 0 && writeError == 0)
+                writeError = errno;
+        fileDescriptor = -1;
+exit:
+        if (writeError != 0) {
+                if (error != NULL)
+                        *error = [NSError errorWithDomain:NSPOSIXErrorDomain
+                                                     code:writeError
+                                                 userInfo:[NSDictionary dictionaryWithObjectsAndKeys:path, NSFilePathErrorKey, nil]];
+                success = NO;
+        }
+        return success;
+}
+
+@end
@@ -0,0 +1,183 @@
+/**
+ * \file PLInterpreterTranscriptIndex.h
+ * \brief Liasis Python IDE interpreter transcript index
+ *
+ * \details This file contains the interface for the interpreter transcript
+ *          index. It records the line starts and the command boundaries of the
+ *          interpreter transcript as the transcript is edited.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * \brief The boundaries of a command in the interpreter transcript.
+ */
+typedef struct {
+        /**
+         * \brief The location of the prompt of the first line of the command.
+         */
+        NSUInteger promptLocation;
+        
+        /**
+         * \brief The range of the input of the command, from the end of the
+         *        first prompt to the end of the last input line.
+         */
+        NSRange inputRange;
+        
+        /**
+         * \brief The range of the output of the command, including output
+         *        written before the next prompt.
+         */
+        NSRange outputRange;
+} PLInterpreterTranscriptCommand;
+
+/**
+ * \class PLInterpreterTranscriptIndex \headerfile \headerfile
+ * \brief Index the lines and commands of the interpreter transcript.
+ *
+ * \details The transcript index keeps a sorted array of line start locations
+ *          and a sorted array of command boundaries, so that finding a line, a
+ *          command or a character offset is a binary search instead of a scan
+ *          of the whole transcript string.
+ *
+ *          The index is told about every edit of the transcript. Edits near the
+ *          end of the transcript, which is where the interpreter appends
+ *          output, only scan the edited text and update the entries at the end
+ *          of the arrays. Edits earlier in the transcript, such as expanding a
+ *          folded line, also shift the entries that follow.
+ */
+@interface PLInterpreterTranscriptIndex : NSObject {
+        /**
+         * \brief The sorted locations of the first character of each line.
+         *        The first entry is always zero.
+         */
+        NSUInteger * lineStarts;
+        
+        /**
+         * \brief The number of entries in lineStarts.
+         */
+        NSUInteger lineCount;
+        
+        /**
+         * \brief The capacity of lineStarts.
+         */
+        NSUInteger lineCapacity;
+        
+        /**
+         * \brief The commands of the transcript, sorted by prompt location.
+         */
+        PLInterpreterTranscriptCommand * commands;
+        
+        /**
+         * \brief The number of entries in commands.
+         */
+        NSUInteger commandCount;
+        
+        /**
+         * \brief The capacity of commands.
+         */
+        NSUInteger commandCapacity;
+}
+
+#pragma mark Properties
+
+@property(readonly) NSUInteger lineCount;
+@property(readonly) NSUInteger commandCount;
+
+#pragma mark Initialization
+
+/**
+ * \brief Initialize the index with the lines of a transcript.
+ *
+ * \param transcript The current transcript string.
+ *
+ * \return An initialized PLInterpreterTranscriptIndex object.
+ */
+-(id)initWithString:(NSString *)transcript;
+
+#pragma mark Updating the Index
+
+/**
+ * \brief Update the index after an edit of the transcript.
+ *
+ * \param editedRange The range of the edited characters in the edited
+ *                    transcript.
+ *
+ * \param delta The change in length of the transcript.
+ *
+ * \param transcript The edited transcript string.
+ */
+-(void)didEditRange:(NSRange)editedRange changeInLength:(NSInteger)delta string:(NSString *)transcript;
+
+/**
+ * \brief Add a command to the end of the index.
+ *
+ * \param command The boundaries of the command.
+ */
+-(void)addCommand:(PLInterpreterTranscriptCommand)command;
+
+#pragma mark Lines
+
+/**
+ * \brief Return the zero-based line number containing a character.
+ *
+ * \param index The location of the character.
+ *
+ * \return The line number.
+ */
+-(NSUInteger)lineNumberForCharacterIndex:(NSUInteger)index;
+
+/**
+ * \brief Return the location of the first character of a line.
+ *
+ * \param lineNumber The zero-based line number.
+ *
+ * \return The location of the line, or NSNotFound if there is no such line.
+ */
+-(NSUInteger)characterIndexForLineNumber:(NSUInteger)lineNumber;
+
+#pragma mark Commands
+
+/**
+ * \brief Return the boundaries of a command.
+ *
+ * \param commandIndex The zero-based index of the command.
+ *
+ * \return The boundaries of the command.
+ */
+-(PLInterpreterTranscriptCommand)commandAtIndex:(NSUInteger)commandIndex;
+
+/**
+ * \brief Return the index of the last command beginning at or before a
+ *        character.
+ *
+ * \param index The location of the character.
+ *
+ * \return The index of the command, or NSNotFound if the character precedes
+ *         the first command.
+ */
+-(NSUInteger)commandIndexForCharacterIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,246 @@
+/**
+ * \file PLInterpreterTranscriptIndex.m
+ * \brief Liasis Python IDE interpreter transcript index
+ *
+ * \details This file contains the implementation for the interpreter transcript
+ *          index. It records the line starts and the command boundaries of the
+ *          interpreter transcript as the transcript is edited.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import "PLInterpreterTranscriptIndex.h"
+
+/**
+ * \brief Move a transcript location across an edit.
+ *
+ * \details Locations before the edit are unchanged, locations at or after the
+ *          end of the replaced characters move with the text that follows, and
+ *          locations inside the replaced characters move to the start of the
+ *          edit.
+ *
+ * \param location The location before the edit.
+ *
+ * \param editLocation The location of the edit.
+ *
+ * \param replacedEnd The end of the replaced characters, before the edit.
+ *
+ * \param delta The change in length of the transcript.
+ *
+ * \return The location after the edit.
+ */
+static NSUInteger PLTranscriptIndexMoveLocation(NSUInteger location, NSUInteger editLocation, NSUInteger replacedEnd, NSInteger delta)
+{
+        if (location < editLocation)
+                return location;
+        if (location >= replacedEnd)
+                return (NSUInteger)((NSInteger)location + delta);
+        return editLocation;
+}
+
+/**
+ * \brief Move a transcript range across an edit.
+ *
+ * \param range The range before the edit.
+ *
+ * \param editLocation The location of the edit.
+ *
+ * \param replacedEnd The end of the replaced characters, before the edit.
+ *
+ * \param delta The change in length of the transcript.
+ *
+ * \return The range after the edit.
+ */
+static NSRange PLTranscriptIndexMoveRange(NSRange range, NSUInteger editLocation, NSUInteger replacedEnd, NSInteger delta)
+{
+        NSUInteger start = PLTranscriptIndexMoveLocation(range.location, editLocation, replacedEnd, delta);
+        NSUInteger end = PLTranscriptIndexMoveLocation(NSMaxRange(range), editLocation, replacedEnd, delta);
+        return NSMakeRange(start, end - start);
+}
+
+#pragma mark -
+
+@implementation PLInterpreterTranscriptIndex
+
+@synthesize lineCount;
+@synthesize commandCount;
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize the index of an empty transcript.
+ *
+ * \return An initialized PLInterpreterTranscriptIndex object.
+ */
+-(id)init
+{
+        return [self initWithString:@""];
+}
+
+-(id)initWithString:(NSString *)transcript
+{
+        self = [super init];
+        if (self) {
+                lineCapacity = 1024;
+                lineStarts = malloc(lineCapacity * sizeof(NSUInteger));
+                lineStarts[0] = 0;
+                lineCount = 1;
+                commandCapacity = 64;
+                commands = malloc(commandCapacity * sizeof(PLInterpreterTranscriptCommand));
+                commandCount = 0;
+                [self didEditRange:NSMakeRange(0, [transcript length])
+                    changeInLength:(NSInteger)[transcript length]
+                            string:transcript];
+        }
+        return self;
+}
+
+/**
+ * \brief Free the line and command arrays.
+ */
+-(void)dealloc
+{
+        free(lineStarts);
+        free(commands);
+        [super dealloc];
+}
+
+#pragma mark Updating the Index
+
+/**
+ * \brief Return the index of the first line starting after a location.
+ *
+ * \param location The character location.
+ *
+ * \return The index in lineStarts of the first entry greater than location,
+ *         or lineCount if there is none.
+ */
+-(NSUInteger)lineIndexAfterLocation:(NSUInteger)location
+{
+        NSUInteger low = 0, high = lineCount, middle;
+        while (low < high) {
+                middle = low + (high - low)/2;
+                if (lineStarts[middle] <= location)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        return low;
+}
+
+/**
+ * \brief Append a line start, growing the array if needed.
+ *
+ * \param location The location of the first character of the line.
+ */
+-(void)appendLineStart:(NSUInteger)location
+{
+        if (lineCount == lineCapacity) {
+                lineCapacity *= 2;
+                lineStarts = realloc(lineStarts, lineCapacity * sizeof(NSUInteger));
+        }
+        lineStarts[lineCount++] = location;
+}
+
+-(void)didEditRange:(NSRange)editedRange changeInLength:(NSInteger)delta string:(NSString *)transcript
+{
+        NSUInteger replacedEnd = (NSUInteger)((NSInteger)NSMaxRange(editedRange) - delta);
+        NSUInteger first, last, i, tailCount;
+        NSUInteger * tail = NULL;
+        NSRange searchRange, newline;
+        
+        first = [self lineIndexAfterLocation:editedRange.location];
+        last = [self lineIndexAfterLocation:replacedEnd];
+        tailCount = lineCount - last;
+        if (tailCount > 0) {
+                tail = malloc(tailCount * sizeof(NSUInteger));
+                for (i = 0; i < tailCount; i++)
+                        tail[i] = (NSUInteger)((NSInteger)lineStarts[last + i] + delta);
+        }
+        lineCount = first;
+        searchRange = editedRange;
+        while (searchRange.length > 0) {
+                newline = [transcript rangeOfString:@"\n" options:NSLiteralSearch range:searchRange];
+                if (newline.location == NSNotFound)
+                        break;
+                [self appendLineStart:NSMaxRange(newline)];
+                searchRange = NSMakeRange(NSMaxRange(newline), NSMaxRange(editedRange) - NSMaxRange(newline));
+        }
+        for (i = 0; i < tailCount; i++)
+                [self appendLineStart:tail[i]];
+        free(tail);
+        
+        for (i = commandCount; i > 0; i--) {
+                if (NSMaxRange(commands[i-1].outputRange) < editedRange.location)
+                        break;
+                commands[i-1].promptLocation = PLTranscriptIndexMoveLocation(commands[i-1].promptLocation, editedRange.location, replacedEnd, delta);
+                commands[i-1].inputRange = PLTranscriptIndexMoveRange(commands[i-1].inputRange, editedRange.location, replacedEnd, delta);
+                commands[i-1].outputRange = PLTranscriptIndexMoveRange(commands[i-1].outputRange, editedRange.location, replacedEnd, delta);
+        }
+}
+
+-(void)addCommand:(PLInterpreterTranscriptCommand)command
+{
+        if (commandCount == commandCapacity) {
+                commandCapacity *= 2;
+                commands = realloc(commands, commandCapacity * sizeof(PLInterpreterTranscriptCommand));
+        }
+        commands[commandCount++] = command;
+}
+
+#pragma mark Lines
+
+-(NSUInteger)lineNumberForCharacterIndex:(NSUInteger)index
+{
+        return [self lineIndexAfterLocation:index] - 1;
+}
+
+-(NSUInteger)characterIndexForLineNumber:(NSUInteger)lineNumber
+{
+        return (lineNumber < lineCount) ? lineStarts[lineNumber] : NSNotFound;
+}
+
+#pragma mark Commands
+
+-(PLInterpreterTranscriptCommand)commandAtIndex:(NSUInteger)commandIndex
+{
+        if (commandIndex >= commandCount)
+                [NSException raise:NSRangeException
+                            format:@"Command index %lu beyond bounds (%lu)", (unsigned long)commandIndex, (unsigned long)commandCount];
+        return commands[commandIndex];
+}
+
+-(NSUInteger)commandIndexForCharacterIndex:(NSUInteger)index
+{
+        NSUInteger low = 0, high = commandCount, middle;
+        while (low < high) {
+                middle = low + (high - low)/2;
+                if (commands[middle].promptLocation <= index)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        return (low == 0) ? NSNotFound : low - 1;
+}
+
+@end
@@ -0,0 +1,167 @@
+/**
+ * \file PLInterpreterTranscriptSearch.h
+ * \brief Liasis Python IDE interpreter transcript search
+ *
+ * \details This file contains the public interface for searching the
+ *          interpreter transcript with an index built in the background.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * \brief The number of characters of the transcript covered by each chunk of
+ *        the search index.
+ */
+#define PLInterpreterTranscriptSearchChunkLength 16384
+
+/**
+ * \brief The number of 64-bit words in the trigram filter of each chunk.
+ */
+#define PLInterpreterTranscriptSearchFilterWords 64
+
+/**
+ * \brief The trigram filter of a chunk of the transcript.
+ *
+ * \details Each trigram starting in the chunk sets one bit of the filter. A
+ *          string can only occur in a chunk when all of its trigrams are set
+ *          in the filter of the chunk or of the following chunk.
+ */
+typedef struct {
+        uint64_t trigrams[PLInterpreterTranscriptSearchFilterWords];
+} PLInterpreterTranscriptSearchChunk;
+
+/**
+ * \brief A block receiving the matches of a transcript search.
+ *
+ * \param matches An array of NSValue objects containing the ranges of the
+ *                matches found since the last call, in transcript order.
+ *
+ * \param finished Whether or not the search is complete.
+ */
+typedef void (^PLInterpreterTranscriptSearchHandler)(NSArray * matches, BOOL finished);
+
+/**
+ * \class PLInterpreterTranscriptSearch \headerfile \headerfile
+ * \brief Search the interpreter transcript without blocking the interface.
+ *
+ * \details The transcript search keeps a copy of the transcript characters and
+ *          a trigram filter for each chunk of the copy, both owned by a serial
+ *          background queue. The transcript is only copied from the first
+ *          edited location, so the appended output of each command is indexed
+ *          without copying the rest of the transcript again.
+ *
+ *          A search skips every chunk whose filter excludes the search string,
+ *          and verifies the remaining chunks by comparing characters. Searches
+ *          are case-insensitive for ASCII letters. Matches are delivered in
+ *          batches on the main queue as the chunks are searched, and starting
+ *          a new search cancels the previous one.
+ */
+@interface PLInterpreterTranscriptSearch : NSObject {
+        /**
+         * \brief The serial queue owning the transcript copy and the chunk
+         *        filters.
+         */
+        dispatch_queue_t indexQueue;
+        
+        /**
+         * \brief The copy of the transcript characters, with ASCII letters in
+         *        lowercase.
+         */
+        unichar * characters;
+        
+        /**
+         * \brief The number of characters in the transcript copy.
+         */
+        NSUInteger length;
+        
+        /**
+         * \brief The capacity of characters.
+         */
+        NSUInteger capacity;
+        
+        /**
+         * \brief The trigram filters of the chunks of the transcript copy.
+         */
+        PLInterpreterTranscriptSearchChunk * chunks;
+        
+        /**
+         * \brief The number of entries in chunks.
+         */
+        NSUInteger chunkCount;
+        
+        /**
+         * \brief The first location of the transcript edited since the last
+         *        update of the copy. Only used on the main thread.
+         */
+        NSUInteger editedLocation;
+        
+        /**
+         * \brief Incremented for every search, so that a running search can
+         *        notice it was cancelled.
+         */
+        volatile int32_t searchGeneration;
+}
+
+#pragma mark Updating the Index
+
+/**
+ * \brief Note an edit of the transcript.
+ *
+ * \details The index is not updated until the next call to updateWithString:.
+ *
+ * \param editedRange The range of the edited characters in the edited
+ *                    transcript.
+ */
+-(void)didEditRange:(NSRange)editedRange;
+
+/**
+ * \brief Copy the edited part of the transcript and index it in the
+ *        background.
+ *
+ * \param transcript The current transcript string.
+ */
+-(void)updateWithString:(NSString *)transcript;
+
+#pragma mark Searching
+
+/**
+ * \brief Search the transcript for a string.
+ *
+ * \details The search runs on the index queue after the pending updates, and
+ *          the handler is called on the main queue, at least once with
+ *          finished set to YES unless the search is cancelled.
+ *
+ * \param string The string to search for.
+ *
+ * \param handler The block receiving the matches.
+ */
+-(void)searchForString:(NSString *)string resultHandler:(PLInterpreterTranscriptSearchHandler)handler;
+
+/**
+ * \brief Cancel the running search. Its handler is not called again.
+ */
+-(void)cancelSearch;
+
+@end
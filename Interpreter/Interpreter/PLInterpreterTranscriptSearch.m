@@ -0,0 +1,276 @@
+/**
+ * \file PLInterpreterTranscriptSearch.m
+ * \brief Liasis Python IDE interpreter transcript search
+ *
+ * \details This file contains the implementation for searching the interpreter
+ *          transcript with an index built in the background.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <libkern/OSAtomic.h>
+#import "PLInterpreterTranscriptSearch.h"
+
+/**
+ * \brief The number of matches collected before a batch is delivered.
+ */
+#define PLInterpreterTranscriptSearchBatchLength 256
+
+/**
+ * \brief Fold a character for case-insensitive comparison.
+ *
+ * \param character The character.
+ *
+ * \return The character, with ASCII letters in lowercase.
+ */
+static inline unichar PLTranscriptSearchFold(unichar character)
+{
+        return (character >= 'A' && character <= 'Z') ? (unichar)(character + ('a' - 'A')) : character;
+}
+
+/**
+ * \brief Return the filter bit of a trigram.
+ *
+ * \param trigram The first of the three folded characters.
+ *
+ * \return The index of the bit in the chunk filter.
+ */
+static inline NSUInteger PLTranscriptSearchTrigramBit(const unichar * trigram)
+{
+        NSUInteger hash = ((NSUInteger)trigram[0] * 961) + ((NSUInteger)trigram[1] * 31) + trigram[2];
+        return (hash ^ (hash >> 12)) % (PLInterpreterTranscriptSearchFilterWords * 64);
+}
+
+#pragma mark -
+
+@implementation PLInterpreterTranscriptSearch
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize the search of an empty transcript.
+ *
+ * \return An initialized PLInterpreterTranscriptSearch object.
+ */
+-(id)init
+{
+        self = [super init];
+        if (self) {
+                indexQueue = dispatch_queue_create("org.liasis.interpreter.transcript-search", DISPATCH_QUEUE_SERIAL);
+                capacity = PLInterpreterTranscriptSearchChunkLength;
+                characters = malloc(capacity * sizeof(unichar));
+                length = 0;
+                chunks = NULL;
+                chunkCount = 0;
+                editedLocation = 0;
+                searchGeneration = 0;
+        }
+        return self;
+}
+
+/**
+ * \brief Cancel the running search and free the index.
+ *
+ * \details The pending blocks on the index queue retain the receiver, so the
+ *          queue is idle by the time it is released.
+ */
+-(void)dealloc
+{
+        dispatch_release(indexQueue);
+        free(characters);
+        free(chunks);
+        [super dealloc];
+}
+
+#pragma mark Updating the Index
+
+-(void)didEditRange:(NSRange)editedRange
+{
+        if (editedRange.location < editedLocation)
+                editedLocation = editedRange.location;
+}
+
+/**
+ * \brief Replace the end of the transcript copy and rebuild the affected chunk
+ *        filters. Only called on the index queue.
+ *
+ * \param tail The transcript characters from location to the end.
+ *
+ * \param location The location of the first character of tail.
+ */
+-(void)replaceCharactersFromLocation:(NSUInteger)location withString:(NSString *)tail
+{
+        NSUInteger newLength = location + [tail length];
+        NSUInteger firstChunk, i, end;
+        PLInterpreterTranscriptSearchChunk * chunk;
+        
+        if (newLength > capacity) {
+                while (capacity < newLength)
+                        capacity *= 2;
+                characters = realloc(characters, capacity * sizeof(unichar));
+        }
+        [tail getCharacters:characters + location range:NSMakeRange(0, [tail length])];
+        for (i = location; i < newLength; i++)
+                characters[i] = PLTranscriptSearchFold(characters[i]);
+        length = newLength;
+        
+        /* Trigrams starting up to two characters before the edit read it. */
+        firstChunk = ((location > 2) ? location - 2 : 0) / PLInterpreterTranscriptSearchChunkLength;
+        chunkCount = (length + PLInterpreterTranscriptSearchChunkLength - 1) / PLInterpreterTranscriptSearchChunkLength;
+        chunks = realloc(chunks, MAX(chunkCount, 1) * sizeof(PLInterpreterTranscriptSearchChunk));
+        for (i = firstChunk; i < chunkCount; i++) {
+                chunk = chunks + i;
+                memset(chunk, 0, sizeof(PLInterpreterTranscriptSearchChunk));
+                end = MIN((i + 1) * PLInterpreterTranscriptSearchChunkLength, (length > 2) ? length - 2 : 0);
+                for (location = i * PLInterpreterTranscriptSearchChunkLength; location < end; location++) {
+                        NSUInteger bit = PLTranscriptSearchTrigramBit(characters + location);
+                        chunk->trigrams[bit / 64] |= (uint64_t)1 << (bit % 64);
+                }
+        }
+}
+
+-(void)updateWithString:(NSString *)transcript
+{
+        NSUInteger location = editedLocation;
+        NSString * tail;
+        if (location > [transcript length])
+                location = [transcript length];
+        tail = [transcript substringFromIndex:location];
+        editedLocation = [transcript length];
+        dispatch_async(indexQueue, ^{
+                [self replaceCharactersFromLocation:location withString:tail];
+        });
+}
+
+#pragma mark Searching
+
+/**
+ * \brief Deliver a batch of matches on the main queue, unless the search was
+ *        cancelled.
+ *
+ * \param matches The matches found since the last batch.
+ *
+ * \param finished Whether or not the search is complete.
+ *
+ * \param generation The generation of the search.
+ *
+ * \param handler The block receiving the matches.
+ */
+-(void)deliverMatches:(NSArray *)matches finished:(BOOL)finished generation:(int32_t)generation handler:(PLInterpreterTranscriptSearchHandler)handler
+{
+        dispatch_async(dispatch_get_main_queue(), ^{
+                if (generation == searchGeneration)
+                        handler(matches, finished);
+        });
+}
+
+/**
+ * \brief Search the transcript copy. Only called on the index queue.
+ *
+ * \param needle The folded characters to search for.
+ *
+ * \param needleLength The number of characters in needle.
+ *
+ * \param generation The generation of the search.
+ *
+ * \param handler The block receiving the matches.
+ */
+-(void)searchForCharacters:(const unichar *)needle length:(NSUInteger)needleLength generation:(int32_t)generation handler:(PLInterpreterTranscriptSearchHandler)handler
+{
+        PLInterpreterTranscriptSearchChunk needleFilter;
+        NSMutableArray * matches = [NSMutableArray array];
+        NSUInteger i, j, bit, location, end;
+        BOOL filtered = (needleLength >= 3 && needleLength <= PLInterpreterTranscriptSearchChunkLength);
+        uint64_t word;
+        
+        if (length < needleLength) {
+                [self deliverMatches:matches finished:YES generation:generation handler:handler];
+                return;
+        }
+        memset(&needleFilter, 0, sizeof(needleFilter));
+        for (i = 0; filtered && i + 2 < needleLength; i++) {
+                bit = PLTranscriptSearchTrigramBit(needle + i);
+                needleFilter.trigrams[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+        for (i = 0; i < chunkCount; i++) {
+                if (generation != searchGeneration)
+                        return;
+                if (filtered) {
+                        for (j = 0; j < PLInterpreterTranscriptSearchFilterWords; j++) {
+                                word = chunks[i].trigrams[j];
+                                if (i + 1 < chunkCount)
+                                        word |= chunks[i+1].trigrams[j];
+                                if ((needleFilter.trigrams[j] & ~word) != 0)
+                                        break;
+                        }
+                        if (j < PLInterpreterTranscriptSearchFilterWords)
+                                continue;
+                }
+                /* Matches starting in the chunk may end in the next one. */
+                location = i * PLInterpreterTranscriptSearchChunkLength;
+                end = MIN(location + PLInterpreterTranscriptSearchChunkLength, length - needleLength + 1);
+                for (; location < end; location++) {
+                        if (characters[location] != needle[0])
+                                continue;
+                        if (memcmp(characters + location + 1, needle + 1, (needleLength - 1) * sizeof(unichar)) != 0)
+                                continue;
+                        [matches addObject:[NSValue valueWithRange:NSMakeRange(location, needleLength)]];
+                        location += needleLength - 1;
+                }
+                if ([matches count] >= PLInterpreterTranscriptSearchBatchLength) {
+                        [self deliverMatches:matches finished:NO generation:generation handler:handler];
+                        matches = [NSMutableArray array];
+                }
+        }
+        [self deliverMatches:matches finished:YES generation:generation handler:handler];
+}
+
+-(void)searchForString:(NSString *)string resultHandler:(PLInterpreterTranscriptSearchHandler)handler
+{
+        NSUInteger needleLength = [string length], i;
+        int32_t generation = OSAtomicIncrement32Barrier(&searchGeneration);
+        unichar * needle;
+        
+        handler = [[handler copy] autorelease];
+        if (needleLength == 0) {
+                handler([NSArray array], YES);
+                return;
+        }
+        needle = malloc(needleLength * sizeof(unichar));
+        [string getCharacters:needle range:NSMakeRange(0, needleLength)];
+        for (i = 0; i < needleLength; i++)
+                needle[i] = PLTranscriptSearchFold(needle[i]);
+        dispatch_async(indexQueue, ^{
+                NSAutoreleasePool * pool = [[NSAutoreleasePool alloc] init];
+                [self searchForCharacters:needle length:needleLength generation:generation handler:handler];
+                [pool drain];
+                free(needle);
+        });
+}
+
+-(void)cancelSearch
+{
+        OSAtomicIncrement32Barrier(&searchGeneration);
+}
+
+@end
@@ -0,0 +1,174 @@
+/**
+ * \file PLInterpreterWatchList.h
+ * \brief Liasis Python IDE interpreter watch list
+ *
+ * \details This file contains the interface of the watch expressions re-
+ *          evaluated after each interpreter command.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <Python/Python.h>
+
+/**
+ * \brief Posted when a watch expression is added or removed. The object is
+ *        the watch list.
+ */
+extern NSString * const PLInterpreterWatchListDidChangeNotification;
+
+/**
+ * \class PLInterpreterWatch \headerfile \headerfile
+ * \brief A watch expression, its compiled code and its last value.
+ */
+@interface PLInterpreterWatch : NSObject {
+        /**
+         * \brief The expression.
+         */
+        NSString * expression;
+        
+        /**
+         * \brief The expression compiled for evaluation.
+         */
+        PyObject * code;
+        
+        /**
+         * \brief The global names the expression reads.
+         */
+        NSSet * names;
+        
+        /**
+         * \brief The values of the names at the last evaluation, a tuple
+         *        holding NULL for names that were not defined, or NULL before
+         *        the first evaluation.
+         */
+        PyObject * values;
+        
+        /**
+         * \brief The repr of the value of the last evaluation, or its error.
+         */
+        NSString * valueString;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The expression.
+ */
+@property(readonly) NSString * expression;
+
+/**
+ * \brief The repr of the value of the last evaluation, or its error.
+ */
+@property(readonly) NSString * valueString;
+
+@end
+
+/**
+ * \class PLInterpreterWatchList \headerfile \headerfile
+ * \brief The watch expressions of the interpreter.
+ *
+ * \details Each expression is compiled once, when it is added. After each
+ *          command, an expression is evaluated again only if one of the
+ *          global names it reads was rebound, was read or stored by the
+ *          command, or holds a mutable object, since the command may have
+ *          changed the object in place, directly or through a function it
+ *          called. Expressions reading only immutable values that were not
+ *          rebound are skipped.
+ *          Each evaluation has a time budget, enforced by a watchdog that
+ *          interrupts the evaluation with a pending call, so that an
+ *          expensive expression cannot hold up the prompt.
+ *
+ *          The globals of the interpreter are shared by the process, so a
+ *          single watch list is shared by all interpreters rather than kept
+ *          for each interpreter tab: the expressions of one tab would read
+ *          the same globals as those of any other.
+ */
+@interface PLInterpreterWatchList : NSObject {
+        /**
+         * \brief The watch expressions, as PLInterpreterWatch objects.
+         */
+        NSMutableArray * watches;
+}
+
+#pragma mark Properties
+
+/**
+ * \brief The watch expressions, as PLInterpreterWatch objects.
+ */
+@property(readonly) NSArray * watches;
+
+#pragma mark Shared Watch List
+
+/**
+ * \brief Return the watch list shared by the process.
+ *
+ * \return The shared PLInterpreterWatchList object.
+ */
++(PLInterpreterWatchList *)sharedWatchList;
+
+#pragma mark Watch Expressions
+
+/**
+ * \brief Add a watch expression.
+ *
+ * \details The global interpreter lock must be held.
+ *
+ * \param expression The expression.
+ *
+ * \return YES if the expression was added, or NO with a Python exception set
+ *         if it does not compile.
+ */
+-(BOOL)addExpression:(NSString *)expression;
+
+/**
+ * \brief Remove a watch expression.
+ *
+ * \param expression The expression.
+ */
+-(void)removeExpression:(NSString *)expression;
+
+/**
+ * \brief Remove all watch expressions.
+ */
+-(void)removeAllExpressions;
+
+#pragma mark Evaluation
+
+/**
+ * \brief Evaluate the watch expressions affected by a command.
+ *
+ * \details The global interpreter lock must be held.
+ *
+ * \param globals The globals of the interpreter.
+ *
+ * \param commandNames The global names used by the command, or nil if they
+ *                     are not known, which evaluates every expression.
+ *
+ * \param budget The time budget of each evaluation, in seconds.
+ *
+ * \return YES if a value changed.
+ */
+-(BOOL)evaluateWithGlobals:(PyObject *)globals commandNames:(NSSet *)commandNames budget:(NSTimeInterval)budget;
+
+@end
@@ -0,0 +1,345 @@
+/**
+ * \file PLInterpreterWatchList.m
+ * \brief Liasis Python IDE interpreter watch list
+ *
+ * \details This file contains the implementation of the watch expressions re-
+ *          evaluated after each interpreter command.
+ *
+ * \copyright Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+ *
+ * This file is part of the Python Liasis IDE.
+ *
+ * The Python Liasis IDE is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Python Liasis IDE is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \author Jason Lomnitz.
+ * \author Danny Nicklas
+ * \date 2012-2014.
+ */
+
+
+
+#import "PLInterpreterWatchList.h"
+#import "PLInterpreterNameCheck.h"
+#import <libkern/OSAtomic.h>
+
+NSString * const PLInterpreterWatchListDidChangeNotification = @"PLInterpreterWatchListDidChangeNotification";
+
+/**
+ * \brief The maximum length of a displayed value.
+ */
+static const NSUInteger PLInterpreterWatchMaximumValueLength = 1000;
+
+/**
+ * \brief Incremented before and after each evaluation, so that the watchdog
+ *        of a finished evaluation does nothing.
+ */
+static volatile int32_t PLInterpreterWatchGeneration = 0;
+
+/**
+ * \brief Interrupt the evaluation of a watch expression that exceeded its
+ *        time budget.
+ *
+ * \details This function is run by the interpreter as a pending call, between
+ *          two bytecodes of the evaluation.
+ *
+ * \param argument The generation of the evaluation to interrupt.
+ *
+ * \return -1 with an exception set if the evaluation is still running,
+ *         otherwise 0.
+ */
+static int PLInterpreterWatchInterrupt(void * argument)
+{
+        if ((int32_t)(intptr_t)argument != PLInterpreterWatchGeneration)
+                return 0;
+        PyErr_SetString(PyExc_RuntimeError, "the watch expression exceeded its time budget");
+        return -1;
+}
+
+/**
+ * \brief Return whether or not a value cannot change in place.
+ *
+ * \details None, booleans, numbers and strings are immutable, and so are
+ *          tuples and frozensets of immutable values. Every other value,
+ *          including modules and functions, may change without being rebound.
+ *
+ * \param value The value.
+ *
+ * \return YES if the value is immutable.
+ */
+static BOOL PLInterpreterWatchIsImmutable(PyObject * value)
+{
+        PyObject * iterator, * item;
+        BOOL immutable = YES;
+        if (value == Py_None || PyBool_Check(value) || PyInt_CheckExact(value) || PyLong_CheckExact(value) ||
+            PyFloat_CheckExact(value) || PyComplex_CheckExact(value) || PyString_CheckExact(value) || PyUnicode_CheckExact(value))
+                return YES;
+        if (PyTuple_CheckExact(value) == NO && PyFrozenSet_CheckExact(value) == NO)
+                return NO;
+        iterator = PyObject_GetIter(value);
+        while (immutable && iterator != NULL && (item = PyIter_Next(iterator)) != NULL) {
+                immutable = PLInterpreterWatchIsImmutable(item);
+                Py_DECREF(item);
+        }
+        Py_XDECREF(iterator);
+        PyErr_Clear();
+        return immutable;
+}
+
+#pragma mark -
+
+@implementation PLInterpreterWatch
+
+@synthesize expression;
+@synthesize valueString;
+
+#pragma mark Initialization and Deallocation
+
+/**
+ * \brief Initialize a watch by compiling its expression.
+ *
+ * \param anExpression The expression.
+ *
+ * \return An initialized PLInterpreterWatch object, or nil with a Python
+ *         exception set if the expression does not compile.
+ */
+-(id)initWithExpression:(NSString *)anExpression
+{
+        self = [super init];
+        if (self == nil)
+                return nil;
+        code = Py_CompileString([anExpression UTF8String], "<watch>", Py_eval_input);
+        if (code == NULL) {
+                [self release];
+                return nil;
+        }
+        expression = [anExpression copy];
+        names = [[PLInterpreterNameCheck globalNamesInCode:(PyCodeObject *)code] retain];
+        valueString = @"";
+        return self;
+}
+
+/**
+ * \brief Release the code and the values of the watch.
+ */
+-(void)dealloc
+{
+        Py_XDECREF(code);
+        Py_XDECREF(values);
+        [expression release];
+        [names release];
+        [valueString release];
+        [super dealloc];
+}
+
+#pragma mark Evaluation
+
+/**
+ * \brief Return the current values of the names read by the expression.
+ *
+ * \param globals The globals of the interpreter.
+ *
+ * \return A new reference to a tuple of the values, in the order of the
+ *         sorted names, holding None for names that are not defined.
+ */
+-(PyObject *)valuesInGlobals:(PyObject *)globals
+{
+        NSArray * sortedNames = [[names allObjects] sortedArrayUsingSelector:@selector(compare:)];
+        PyObject * tuple = PyTuple_New((Py_ssize_t)[sortedNames count]), * value;
+        Py_ssize_t i = 0;
+        for (NSString * name in sortedNames) {
+                value = PyDict_GetItemString(globals, [name UTF8String]);
+                if (value == NULL)
+                        value = Py_None;
+                Py_INCREF(value);
+                PyTuple_SET_ITEM(tuple, i++, value);
+        }
+        return tuple;
+}
+
+/**
+ * \brief Return whether or not the expression must be evaluated after a
+ *        command.
+ *
+ * \details The expression is evaluated if it was never evaluated, if it reads
+ *          a name that was rebound since the last evaluation, compared by
+ *          identity, if it reads a name used by the command, or if it reads
+ *          a mutable value, which any command may have changed in place, for
+ *          example through a function it called.
+ *
+ * \param globals The globals of the interpreter.
+ *
+ * \param commandNames The global names used by the command, or nil.
+ *
+ * \return YES if the expression must be evaluated.
+ */
+-(BOOL)needsEvaluationWithGlobals:(PyObject *)globals commandNames:(NSSet *)commandNames
+{
+        PyObject * currentValues;
+        Py_ssize_t i;
+        BOOL changed = NO;
+        if (values == NULL || names == nil || commandNames == nil || [names intersectsSet:commandNames])
+                return YES;
+        currentValues = [self valuesInGlobals:globals];
+        for (i = 0; i < PyTuple_GET_SIZE(values) && changed == NO; i++)
+                changed = (PyTuple_GET_ITEM(values, i) != PyTuple_GET_ITEM(currentValues, i) ||
+                           PLInterpreterWatchIsImmutable(PyTuple_GET_ITEM(currentValues, i)) == NO);
+        Py_DECREF(currentValues);
+        return changed;
+}
+
+/**
+ * \brief Evaluate the expression within a time budget.
+ *
+ * \details A watchdog on a background queue adds a pending call interrupting
+ *          the evaluation once the budget is exceeded. The budget covers the
+ *          repr of the value too, since a repr may be as slow as the
+ *          expression. The values of the names read by the expression are
+ *          kept for the next comparison.
+ *
+ * \param globals The globals of the interpreter.
+ *
+ * \param budget The time budget, in seconds.
+ *
+ * \return YES if the displayed value changed.
+ */
+-(BOOL)evaluateWithGlobals:(PyObject *)globals budget:(NSTimeInterval)budget
+{
+        PyObject * result, * string = NULL, * type, * value, * traceback;
+        NSString * newValueString = nil;
+        int32_t generation;
+        BOOL changed;
+        
+        Py_XDECREF(values);
+        values = [self valuesInGlobals:globals];
+        generation = OSAtomicIncrement32Barrier(&PLInterpreterWatchGeneration);
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(budget * NSEC_PER_SEC)),
+                       dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                if (generation == PLInterpreterWatchGeneration)
+                        Py_AddPendingCall(PLInterpreterWatchInterrupt, (void *)(intptr_t)generation);
+        });
+        result = PyEval_EvalCode((PyCodeObject *)code, globals, globals);
+        if (result != NULL)
+                string = PyObject_Repr(result);
+        OSAtomicIncrement32Barrier(&PLInterpreterWatchGeneration);
+        if (string != NULL && PyString_Check(string))
+                newValueString = [NSString stringWithUTF8String:PyString_AS_STRING(string)];
+        if (PyErr_Occurred()) {
+                PyErr_Fetch(&type, &value, &traceback);
+                PyErr_NormalizeException(&type, &value, &traceback);
+                Py_XDECREF(string);
+                string = (value != NULL) ? PyObject_Str(value) : NULL;
+                newValueString = [NSString stringWithFormat:@"%s: %s",
+                                  (type != NULL && PyType_Check(type)) ? ((PyTypeObject *)type)->tp_name : "Error",
+                                  (string != NULL && PyString_Check(string)) ? PyString_AS_STRING(string) : ""];
+                Py_XDECREF(type);
+                Py_XDECREF(value);
+                Py_XDECREF(traceback);
+                PyErr_Clear();
+        }
+        Py_XDECREF(string);
+        Py_XDECREF(result);
+        if (newValueString == nil)
+                newValueString = @"";
+        if ([newValueString length] > PLInterpreterWatchMaximumValueLength)
+                newValueString = [[newValueString substringToIndex:PLInterpreterWatchMaximumValueLength] stringByAppendingString:@"..."];
+        changed = ([newValueString isEqualToString:valueString] == NO);
+        [valueString release];
+        valueString = [newValueString copy];
+        return changed;
+}
+
+@end
+
+#pragma mark -
+
+@implementation PLInterpreterWatchList
+
+@synthesize watches;
+
+#pragma mark Initialization and Deallocation
+
++(PLInterpreterWatchList *)sharedWatchList
+{
+        static PLInterpreterWatchList * sharedWatchList = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+                sharedWatchList = [[PLInterpreterWatchList alloc] init];
+        });
+        return sharedWatchList;
+}
+
+/**
+ * \brief Initialize an empty watch list.
+ *
+ * \return An initialized PLInterpreterWatchList object.
+ */
+-(id)init
+{
+        self = [super init];
+        if (self) {
+                watches = [[NSMutableArray alloc] init];
+        }
+        return self;
+}
+
+/**
+ * \brief Release the watches.
+ */
+-(void)dealloc
+{
+        [watches release];
+        [super dealloc];
+}
+
+#pragma mark Watch Expressions
+
+-(BOOL)addExpression:(NSString *)expression
+{
+        PLInterpreterWatch * watch = [[PLInterpreterWatch alloc] initWithExpression:expression];
+        if (watch == nil)
+                return NO;
+        [watches addObject:watch];
+        [watch release];
+        [[NSNotificationCenter defaultCenter] postNotificationName:PLInterpreterWatchListDidChangeNotification object:self];
+        return YES;
+}
+
+-(void)removeExpression:(NSString *)expression
+{
+        NSIndexSet * indexes = [watches indexesOfObjectsPassingTest:^BOOL(id watch, NSUInteger index, BOOL * stop) {
+                return [[watch expression] isEqualToString:expression];
+        }];
+        [watches removeObjectsAtIndexes:indexes];
+        [[NSNotificationCenter defaultCenter] postNotificationName:PLInterpreterWatchListDidChangeNotification object:self];
+}
+
+-(void)removeAllExpressions
+{
+        [watches removeAllObjects];
+        [[NSNotificationCenter defaultCenter] postNotificationName:PLInterpreterWatchListDidChangeNotification object:self];
+}
+
+#pragma mark Evaluation
+
+-(BOOL)evaluateWithGlobals:(PyObject *)globals commandNames:(NSSet *)commandNames budget:(NSTimeInterval)budget
+{
+        BOOL changed = NO;
+        for (PLInterpreterWatch * watch in watches) {
+                if ([watch needsEvaluationWithGlobals:globals commandNames:commandNames])
+                        changed |= [watch evaluateWithGlobals:globals budget:budget];
+        }
+        return changed;
+}
+
+@end
@@ -0,0 +1,304 @@
+# liasis_introspection.py
+# Liasis Python IDE interpreter introspection
+#
+# This file contains the introspection helpers of the interpreter, used to show
+# hints about the objects of the interpreter namespace while typing.
+#
+# Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+#
+# This file is part of the Python Liasis IDE.
+#
+# The Python Liasis IDE is free software: you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# The Python Liasis IDE is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+
+"""Introspection helpers of the Liasis interpreter.
+
+Objects are resolved statically: names are looked up in the namespace, module
+and class dictionaries, and no property, __getattr__ or other user code runs,
+so that looking up a hint while typing never has side effects.
+"""
+
+import __builtin__
+import inspect
+import linecache
+import re
+import types
+
+_NOT_FOUND = object()
+
+# Signatures cached by the id of the callable. The callable is kept with its
+# signature, so that the id cannot be reused while the entry exists.
+_signatures = {}
+
+SIGNATURE_CACHE_SIZE = 512
+
+
+def _static_attribute(obj, name):
+    """Look up an attribute without running descriptors or __getattr__."""
+    if isinstance(obj, types.ModuleType):
+        return obj.__dict__.get(name, _NOT_FOUND)
+    if isinstance(obj, (type, types.ClassType)):
+        classes = inspect.getmro(obj)
+    else:
+        instance_dict = getattr(obj, '__dict__', None)
+        if isinstance(instance_dict, dict) and name in instance_dict:
+            return instance_dict[name]
+        classes = inspect.getmro(type(obj))
+    for cls in classes:
+        value = cls.__dict__.get(name, _NOT_FOUND)
+        if value is not _NOT_FOUND:
+            if isinstance(value, (staticmethod, classmethod)):
+                return value.__func__
+            return value
+    return _NOT_FOUND
+
+
+def resolve(expression, namespace):
+    """Resolve a dotted name in a namespace, or return None."""
+    if not re.match(r'^[A-Za-z_]\w*(\.[A-Za-z_]\w*)*$', expression):
+        return None
+    names = expression.split('.')
+    obj = namespace.get(names[0], _NOT_FOUND)
+    if obj is _NOT_FOUND:
+        obj = getattr(__builtin__, names[0], _NOT_FOUND)
+    for name in names[1:]:
+        if obj is _NOT_FOUND:
+            break
+        obj = _static_attribute(obj, name)
+    return None if obj is _NOT_FOUND else obj
+
+
+def _compute_signature(obj):
+    """Return the signature of a callable as a string, or None."""
+    name = getattr(obj, '__name__', None) or type(obj).__name__
+    function = obj
+    skip_first = False
+    if isinstance(obj, (type, types.ClassType)):
+        function = _static_attribute(obj, '__init__')
+        skip_first = True
+    elif isinstance(obj, types.MethodType):
+        function = obj.im_func
+        skip_first = obj.im_self is not None
+    if isinstance(function, types.FunctionType):
+        arguments, varargs, keywords, defaults = inspect.getargspec(function)
+        if skip_first and arguments:
+            arguments = arguments[1:]
+            if defaults and len(defaults) > len(arguments):
+                defaults = defaults[1:]
+        return name + inspect.formatargspec(arguments, varargs, keywords, defaults)
+    documentation = getattr(obj, '__doc__', None)
+    if isinstance(documentation, basestring):
+        for line in documentation.strip().splitlines()[:2]:
+            line = line.strip()
+            if re.match(r'^[\w.]+\(.*\)', line):
+                return line
+    return None
+
+
+def signature(expression, namespace):
+    """Return the signature of the callable named by a dotted expression, or
+    None if it cannot be resolved statically."""
+    obj = resolve(expression, namespace)
+    if obj is None or not callable(obj):
+        return None
+    entry = _signatures.get(id(obj))
+    if entry is not None and entry[0] is obj:
+        return entry[1]
+    try:
+        text = _compute_signature(obj)
+    except Exception:
+        text = None
+    if len(_signatures) >= SIGNATURE_CACHE_SIZE:
+        _signatures.clear()
+    _signatures[id(obj)] = (obj, text)
+    return text
+
+
+# Inspections by the id of the object and the level of detail. The object is
+# kept with its inspection, so that the id cannot be reused while the entry
+# exists.
+_inspections = {}
+
+
+def _code_of(obj):
+    """Return the code object of a function, method or code object, or
+    None."""
+    if isinstance(obj, types.MethodType):
+        obj = obj.im_func
+    if isinstance(obj, types.FunctionType):
+        return obj.func_code
+    return obj if isinstance(obj, types.CodeType) else None
+
+
+def _code_lines(code):
+    """Return the first and last line numbers of a code object and its nested
+    code, from co_firstlineno and co_lnotab, without reading the source."""
+    line = last = code.co_firstlineno
+    for increment in bytearray(code.co_lnotab)[1::2]:
+        line += increment
+        last = max(last, line)
+    for constant in code.co_consts:
+        if isinstance(constant, types.CodeType):
+            last = max(last, _code_lines(constant)[1])
+    return code.co_firstlineno, last
+
+
+def _inspection(obj, expression, source):
+    """Return the inspection of an object, without caching it.
+
+    The source lines of functions and methods are found from their code
+    object, and the line count is that of the first line of their last
+    statement; the interpreter extends it to the end of the indented block as
+    it reads the file. Other objects, such as classes, are located by
+    inspect, which reads the file through linecache."""
+    if source:
+        path = None
+        try:
+            path = inspect.getsourcefile(obj)
+        except TypeError:
+            pass
+        if path is None:
+            return _inspection(obj, expression, False)
+        if isinstance(path, unicode):
+            path = path.encode('utf-8')
+        if isinstance(obj, types.ModuleType):
+            return ('file', '%s (%s)' % (expression, path), path, 1, 0)
+        code = _code_of(obj)
+        if code is not None:
+            first_line, last_line = _code_lines(code)
+            return ('file', '%s (%s, line %d)' % (expression, path, first_line), path, first_line,
+                    last_line - first_line + 1)
+        lines, first_line = inspect.getsourcelines(obj)
+        return ('file', '%s (%s, line %d)' % (expression, path, max(first_line, 1)), path,
+                max(first_line, 1), len(lines))
+    documentation = inspect.getdoc(obj) or 'No documentation.'
+    if isinstance(documentation, unicode):
+        documentation = documentation.encode('utf-8')
+    header = [expression, 'Type: %s' % type(obj).__name__]
+    text = _compute_signature(obj) if callable(obj) else None
+    if text:
+        header.append('Signature: %s' % text)
+    return ('text', expression, '\n'.join(header) + '\n\n' + documentation)
+
+
+def inspection(expression, namespace, source):
+    """Return the documentation, or the source if source is true, of the
+    object named by a dotted expression.
+
+    The result is ('text', title, text) for documentation, or ('file', title,
+    path, first_line, line_count) for source, which is read from the file by
+    the interpreter as it is displayed. A line_count of zero means the rest of
+    the file. None is returned if the name cannot be resolved."""
+    obj = resolve(expression, namespace)
+    if obj is None:
+        return None
+    key = (id(obj), bool(source))
+    entry = _inspections.get(key)
+    if entry is not None and entry[0] is obj:
+        return entry[1]
+    try:
+        result = _inspection(obj, expression, source)
+    except (IOError, TypeError):
+        result = _inspection(obj, expression, False)
+    if len(_inspections) >= SIGNATURE_CACHE_SIZE:
+        _inspections.clear()
+    _inspections[key] = (obj, result)
+    return result
+
+
+# The number of commands registered with linecache.
+_input_count = 0
+
+
+def register_input(source):
+    """Register the source of a command with linecache and return its file
+    name, so that tracebacks, the debugger and the line profiler can show the
+    lines of functions defined in the interpreter."""
+    global _input_count
+    _input_count += 1
+    filename = '<input-%d>' % _input_count
+    lines = [line + '\n' for line in source.splitlines()]
+    linecache.cache[filename] = (len(source), None, lines, filename)
+    return filename
+
+
+# The maximum length of a formatted table cell.
+TABLE_CELL_LENGTH = 200
+
+
+def _is_pandas(obj):
+    """Return whether an object is a pandas Series or DataFrame."""
+    return (type(obj).__module__ or '').startswith('pandas') and hasattr(obj, 'iloc')
+
+
+def _cell(value):
+    """Format a table cell."""
+    if isinstance(value, float) or getattr(getattr(value, 'dtype', None), 'kind', None) == 'f':
+        text = '%.6g' % value
+    elif isinstance(value, basestring):
+        text = value
+    else:
+        text = str(value)
+    if not isinstance(text, unicode):
+        text = text.decode('utf-8', 'replace')
+    return text[:TABLE_CELL_LENGTH].encode('utf-8')
+
+
+def table_shape(obj, max_columns):
+    """Return (row_count, column_count, column_names) of a DataFrame, a
+    Series or an array of one or two dimensions, or None for other objects.
+    Only the names of the first max_columns columns are returned."""
+    if _is_pandas(obj) and obj.ndim == 1:
+        return (len(obj), 1, [_cell(obj.name if obj.name is not None else 0)])
+    if _is_pandas(obj) and obj.ndim == 2:
+        return (obj.shape[0], obj.shape[1], [_cell(name) for name in obj.columns[:max_columns]])
+    if hasattr(obj, '__array_interface__') and getattr(obj, 'ndim', 0) in (1, 2):
+        column_count = 1 if obj.ndim == 1 else obj.shape[1]
+        return (obj.shape[0], column_count, [str(i) for i in xrange(min(column_count, max_columns))])
+    return None
+
+
+def table_page(obj, row, row_count, column, column_count):
+    """Return (labels, rows) for a block of a table: the labels of the rows,
+    and the formatted cells of each row. Only the block is read from the
+    object, so that the cost of a page does not depend on the table size."""
+    if _is_pandas(obj):
+        block = obj.iloc[row:row + row_count]
+        labels = [_cell(label) for label in block.index]
+        values = block.values if obj.ndim == 1 else block.iloc[:, column:column + column_count].values
+    else:
+        block = obj[row:row + row_count]
+        labels = [str(i) for i in xrange(row, row + len(block))]
+        values = block if obj.ndim == 1 else block[:, column:column + column_count]
+    if getattr(values, 'ndim', 2) == 1:
+        return labels, [[_cell(value)] for value in values]
+    return labels, [[_cell(value) for value in line] for line in values]
+
+
+def column_statistics(obj, column):
+    """Return a description of the values of a column of a table: the count,
+    NaN count, minimum, maximum and mean of numbers, or the number of
+    distinct values otherwise."""
+    import numpy
+    if _is_pandas(obj):
+        values = obj.values if obj.ndim == 1 else obj.iloc[:, column].values
+    else:
+        values = obj if obj.ndim == 1 else obj[:, column]
+    values = numpy.asarray(values)
+    if values.dtype.kind not in 'biuf':
+        return 'count=%d, distinct=%d' % (len(values), len(set(values.tolist())))
+    nan_count = int(numpy.isnan(values).sum()) if values.dtype.kind == 'f' else 0
+    if nan_count == len(values):
+        return 'count=%d, NaN count=%d' % (len(values), nan_count)
+    return 'count=%d, NaN count=%d, min=%s, max=%s, mean=%s' % (len(values), nan_count, _cell(numpy.nanmin(values)),
+                                                             _cell(numpy.nanmax(values)), _cell(numpy.nanmean(values)))
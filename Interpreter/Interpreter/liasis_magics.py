@@ -0,0 +1,682 @@
+# liasis_magics.py
+# Liasis Python IDE interpreter magic commands
+#
+# This file contains the magic commands of the interpreter, the lines of input
+# starting with '%' that are handled by Liasis instead of being run as Python.
+#
+# Copyright (C) 2012-2014 Jason Lomnitz and Danny Nicklas.
+#
+# This file is part of the Python Liasis IDE.
+#
+# The Python Liasis IDE is free software: you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# The Python Liasis IDE is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the Python Liasis IDE. If not, see <http://www.gnu.org/licenses/>.
+
+"""Magic commands of the Liasis interpreter.
+
+The interpreter controller calls run_magic with every line of input starting
+with '%'. Magic commands are registered with the magic decorator, and receive
+the rest of the line and the globals of __main__.
+"""
+
+import hashlib
+import os
+import re
+import shutil
+import sys
+import tempfile
+import types
+
+try:
+    import cPickle as pickle
+except ImportError:
+    import pickle
+
+_magics = {}
+
+CACHE_DIRECTORY = os.path.expanduser('~/Library/Caches/Liasis')
+
+
+def magic(name):
+    """Register a function as the magic command %name."""
+    def register(function):
+        _magics[name] = function
+        return function
+    return register
+
+
+def run_magic(line, namespace):
+    """Run a line of input starting with '%' in a namespace."""
+    match = re.match(r'%(\w+)\s*(.*)$', line.strip(), re.DOTALL)
+    if match is None or match.group(1) not in _magics:
+        sys.stderr.write('Unknown magic command: %s\n' % line.split()[0])
+        return
+    _magics[match.group(1)](match.group(2), namespace)
+
+
+@magic('magics')
+def list_magics(argument, namespace):
+    """%magics: list the magic commands."""
+    for name in sorted(_magics):
+        print (_magics[name].__doc__ or '%' + name).split('\n')[0]
+
+
+# Memoization
+
+MEMO_DIRECTORY = os.path.join(CACHE_DIRECTORY, 'memo')
+
+# Arrays of at least this many bytes are stored in their own file and memory
+# mapped when loaded, instead of being copied into the pickle.
+MEMO_MAPPED_ARRAY_BYTES = 1 << 20
+
+
+def _numpy():
+    """Return numpy if it is already imported, without importing it."""
+    return sys.modules.get('numpy')
+
+
+def _referenced_names(code):
+    """Return the global names read by a code object and its nested code."""
+    names = set(code.co_names)
+    for constant in code.co_consts:
+        if isinstance(constant, types.CodeType):
+            names |= _referenced_names(constant)
+    return names
+
+
+class _NotFingerprintable(Exception):
+    """Raised for a value that can only be identified by its id, which is
+    not stable across sessions."""
+
+
+def _fingerprint(value, digest, functions=()):
+    """Add the content of a value to a digest. Functions are fingerprinted
+    by their code, defaults, closure and the globals they read; functions
+    already being fingerprinted are in functions, so that recursion ends.
+    Raise _NotFingerprintable for other values without a content hash."""
+    numpy = _numpy()
+    if value is None or isinstance(value, (bool, int, long, float, complex, str, unicode)):
+        digest.update('%s:%r' % (type(value).__name__, value))
+    elif isinstance(value, (tuple, list, frozenset)):
+        digest.update('%s:%d' % (type(value).__name__, len(value)))
+        for item in value:
+            _fingerprint(item, digest, functions)
+    elif isinstance(value, dict):
+        digest.update('dict:%d' % len(value))
+        for key in sorted(value, key=repr):
+            _fingerprint(key, digest, functions)
+            _fingerprint(value[key], digest, functions)
+    elif numpy is not None and isinstance(value, numpy.ndarray) and value.dtype != object:
+        digest.update('ndarray:%s:%r' % (value.dtype.str, value.shape))
+        digest.update(numpy.ascontiguousarray(value).data)
+    elif isinstance(value, types.ModuleType):
+        digest.update('module:%s' % value.__name__)
+    elif isinstance(value, types.FunctionType) and value in functions:
+        digest.update('recursive:%s' % value.__name__)
+    elif isinstance(value, types.FunctionType):
+        functions = functions + (value,)
+        code = value.func_code
+        digest.update('function:%s' % value.__name__)
+        digest.update(code.co_code)
+        _fingerprint(tuple(c for c in code.co_consts if not isinstance(c, types.CodeType)), digest, functions)
+        _fingerprint(value.func_defaults, digest, functions)
+        _fingerprint(tuple(cell.cell_contents for cell in value.func_closure or ()), digest, functions)
+        for name in sorted(_referenced_names(code)):
+            if name in value.func_globals:
+                digest.update('\0' + name + '\0')
+                _fingerprint(value.func_globals[name], digest, functions)
+    elif isinstance(value, types.BuiltinFunctionType):
+        digest.update('builtin:%s.%s' % (getattr(value, '__module__', None), value.__name__))
+    else:
+        raise _NotFingerprintable(type(value).__name__)
+
+
+def _memo_key(source, namespace):
+    """Return the cache key of an expression and the globals it reads, or
+    raise _NotFingerprintable if one of the globals has no content hash."""
+    digest = hashlib.sha1()
+    digest.update(source)
+    code = compile(source, '<memo>', 'eval')
+    for name in sorted(_referenced_names(code)):
+        if name in namespace:
+            digest.update('\0' + name + '\0')
+            try:
+                _fingerprint(namespace[name], digest)
+            except _NotFingerprintable as error:
+                raise _NotFingerprintable('%s depends on a %s object' % (name, error))
+    return digest.hexdigest()
+
+
+def _store(value, path):
+    """Pickle a value to a new directory, writing large arrays to their own
+    .npy files."""
+    numpy = _numpy()
+    arrays = []
+
+    def persistent_id(obj):
+        if (numpy is not None and type(obj) in (numpy.ndarray, numpy.memmap) and obj.dtype != object
+                and obj.nbytes >= MEMO_MAPPED_ARRAY_BYTES):
+            name = 'array%d.npy' % len(arrays)
+            numpy.save(os.path.join(path, name), obj)
+            arrays.append(name)
+            return name
+        return None
+
+    with open(os.path.join(path, 'result.pickle'), 'wb') as result:
+        pickler = pickle.Pickler(result, pickle.HIGHEST_PROTOCOL)
+        pickler.persistent_id = persistent_id
+        pickler.dump(value)
+
+
+def _load(path):
+    """Load a stored value, memory mapping its large arrays."""
+    def persistent_load(name):
+        import numpy
+        return numpy.load(os.path.join(path, name), mmap_mode='r')
+
+    with open(os.path.join(path, 'result.pickle'), 'rb') as result:
+        unpickler = pickle.Unpickler(result)
+        unpickler.persistent_load = persistent_load
+        return unpickler.load()
+
+
+@magic('memo')
+def memo(argument, namespace):
+    """%memo [name =] expression: evaluate an expression, caching the result on disk.
+
+    The cache key is the expression and the content of the globals it reads,
+    including the globals read by the functions it calls. An expression
+    reading an object without a content hash is evaluated without caching,
+    since its id may be reused by a different object in a later session."""
+    if argument.strip() == '--clear':
+        shutil.rmtree(MEMO_DIRECTORY, ignore_errors=True)
+        return
+    match = re.match(r'([A-Za-z_]\w*)\s*=(?!=)\s*(.*)$', argument, re.DOTALL)
+    target, source = (match.group(1), match.group(2)) if match else (None, argument)
+    source = source.strip()
+    try:
+        key = _memo_key(source, namespace)
+    except _NotFingerprintable as error:
+        sys.stderr.write('%%memo: result not cached: %s, which can only be identified by its id\n' % error)
+        _assign_or_display(target, eval(source, namespace), namespace)
+        return
+    path = os.path.join(MEMO_DIRECTORY, key)
+    if os.path.isdir(path):
+        try:
+            value = _load(path)
+        except Exception:
+            shutil.rmtree(path, ignore_errors=True)
+        else:
+            _assign_or_display(target, value, namespace)
+            return
+    value = eval(source, namespace)
+    if not os.path.isdir(MEMO_DIRECTORY):
+        os.makedirs(MEMO_DIRECTORY)
+    temporary = tempfile.mkdtemp(dir=MEMO_DIRECTORY)
+    try:
+        _store(value, temporary)
+        os.rename(temporary, path)
+    except Exception as error:
+        shutil.rmtree(temporary, ignore_errors=True)
+        sys.stderr.write('%%memo: result not cached: %s\n' % error)
+    _assign_or_display(target, value, namespace)
+
+
+def _assign_or_display(target, value, namespace):
+    """Assign a value to a global, or display it like an expression."""
+    if target is not None:
+        namespace[target] = value
+    else:
+        sys.displayhook(value)
+
+
+# Hibernation
+
+HIBERNATION_PATH = os.path.expanduser('~/Library/Application Support/Liasis/Hibernated Session.liasis')
+
+HIBERNATION_HEADER = 'LIASIS-HIBERNATION-1\n'
+
+# The alignment of array data in the hibernation file, so that arrays can be
+# memory mapped in place.
+HIBERNATION_ALIGNMENT = 64
+
+
+def _hibernation_path(argument):
+    return os.path.expanduser(argument.strip()) if argument.strip() else HIBERNATION_PATH
+
+
+@magic('hibernate')
+def hibernate(argument, namespace):
+    """%hibernate [path]: save the picklable globals of __main__ to a file.
+
+    Functions and classes defined in __main__, and values referring to them,
+    are not saved: pickle stores them by reference to __main__, where they
+    would not exist yet when a new session resumes."""
+    import cStringIO
+    import struct
+    path = _hibernation_path(argument)
+    numpy = _numpy()
+    directory = os.path.dirname(path)
+    if directory and not os.path.isdir(directory):
+        os.makedirs(directory)
+    descriptor, temporary = tempfile.mkstemp(dir=directory or None)
+    index = {}
+    skipped = []
+    with os.fdopen(descriptor, 'wb') as output:
+
+        def persistent_id(obj):
+            if (isinstance(obj, (type, types.ClassType, types.FunctionType))
+                    and getattr(obj, '__module__', None) == '__main__'):
+                raise pickle.PicklingError('%s is defined in __main__' % obj.__name__)
+            if numpy is not None and type(obj) is numpy.ndarray and obj.dtype != object:
+                array = numpy.ascontiguousarray(obj)
+                output.seek(0, os.SEEK_END)
+                output.write('\0' * (-output.tell() % HIBERNATION_ALIGNMENT))
+                offset = output.tell()
+                output.write(buffer(array))
+                return ('array', offset, array.dtype.str, array.shape)
+            return None
+
+        output.write(HIBERNATION_HEADER)
+        output.write(struct.pack('<Q', 0))
+        for name, value in sorted(namespace.items()):
+            if name.startswith('__'):
+                continue
+            if isinstance(value, types.ModuleType):
+                index[name] = ('module', value.__name__)
+                continue
+            start = output.tell()
+            blob = cStringIO.StringIO()
+            pickler = pickle.Pickler(blob, pickle.HIGHEST_PROTOCOL)
+            pickler.persistent_id = persistent_id
+            try:
+                pickler.dump(value)
+            except Exception:
+                output.seek(start)
+                output.truncate()
+                skipped.append(name)
+                continue
+            output.seek(0, os.SEEK_END)
+            index[name] = ('value', output.tell(), len(blob.getvalue()))
+            output.write(blob.getvalue())
+        output.seek(0, os.SEEK_END)
+        index_offset = output.tell()
+        pickle.dump(index, output, pickle.HIGHEST_PROTOCOL)
+        output.seek(len(HIBERNATION_HEADER))
+        output.write(struct.pack('<Q', index_offset))
+        size = index_offset
+    os.rename(temporary, path)
+    print 'Hibernated %d names (%.1f MB) to %s' % (len(index), size / 1048576.0, path)
+    if skipped:
+        print 'Not picklable: %s' % ', '.join(skipped)
+
+
+@magic('resume')
+def resume(argument, namespace):
+    """%resume [path]: restore the globals saved by %hibernate, mapping arrays in place."""
+    import struct
+    path = _hibernation_path(argument)
+    arrays = []
+
+    def persistent_load(persistent):
+        import numpy
+        kind, offset, dtype, shape = persistent
+        array = numpy.memmap(path, dtype=numpy.dtype(dtype), mode='c', offset=offset, shape=shape)
+        arrays.append(array)
+        return array
+
+    failed = []
+    with open(path, 'rb') as hibernated:
+        if hibernated.read(len(HIBERNATION_HEADER)) != HIBERNATION_HEADER:
+            sys.stderr.write('%%resume: %s is not a hibernated session\n' % path)
+            return
+        index_offset, = struct.unpack('<Q', hibernated.read(8))
+        hibernated.seek(index_offset)
+        index = pickle.load(hibernated)
+        for name, entry in sorted(index.items()):
+            try:
+                if entry[0] == 'module':
+                    namespace[name] = __import__(entry[1], fromlist=['*'])
+                    continue
+                hibernated.seek(entry[1])
+                unpickler = pickle.Unpickler(hibernated)
+                unpickler.persistent_load = persistent_load
+                namespace[name] = unpickler.load()
+            except Exception as error:
+                failed.append('%s (%s)' % (name, error))
+    print 'Resumed %d names (%d arrays mapped) from %s' % (len(index) - len(failed), len(arrays), path)
+    if failed:
+        print 'Not restored: %s' % ', '.join(failed)
+
+
+# Parallel map
+
+# The explanation added to the errors of workers that crash or stop
+# responding.
+PARALLEL_FORK_WARNING = ('the workers are forked without exec, which is unsafe once the interpreter has used '
+                         'Grand Central Dispatch, Accelerate or other Apple frameworks')
+
+# Results containing arrays of at least this many bytes pass the array data
+# through a memory mapped file instead of the pipe.
+PARALLEL_MAPPED_ARRAY_BYTES = 1 << 20
+
+# The interval, in seconds, at which the progress of the workers is displayed
+# and the interrupt key is checked.
+PARALLEL_POLL_INTERVAL = 0.05
+
+
+def _read_exactly(descriptor, length):
+    """Read a number of bytes from a pipe, or fewer at end of file."""
+    chunks = []
+    while length > 0:
+        chunk = os.read(descriptor, min(length, 1 << 20))
+        if not chunk:
+            break
+        chunks.append(chunk)
+        length -= len(chunk)
+    return ''.join(chunks)
+
+
+def _parallel_worker(function, items, indices, descriptor, directory):
+    """Apply a function to some items in a forked worker, writing each result
+    to a pipe as a length-prefixed pickle."""
+    import cStringIO
+    import struct
+    import traceback
+    numpy = _numpy()
+
+    def persistent_id(obj):
+        if (numpy is not None and type(obj) is numpy.ndarray and obj.dtype != object
+                and obj.nbytes >= PARALLEL_MAPPED_ARRAY_BYTES):
+            handle, path = tempfile.mkstemp(suffix='.npy', dir=directory)
+            with os.fdopen(handle, 'wb') as array_file:
+                numpy.save(array_file, obj)
+            return path
+        return None
+
+    for index in indices:
+        try:
+            message = (index, True, function(items[index]))
+        except Exception:
+            message = (index, False, traceback.format_exc())
+        blob = cStringIO.StringIO()
+        pickler = pickle.Pickler(blob, pickle.HIGHEST_PROTOCOL)
+        pickler.persistent_id = persistent_id
+        try:
+            pickler.dump(message)
+        except Exception:
+            blob = cStringIO.StringIO()
+            pickle.dump((index, False, traceback.format_exc()), blob, pickle.HIGHEST_PROTOCOL)
+        data = blob.getvalue()
+        os.write(descriptor, struct.pack('<Q', len(data)))
+        view = buffer(data)
+        while view:
+            view = view[os.write(descriptor, view):]
+
+
+@magic('parallel')
+def parallel(argument, namespace):
+    """%parallel [-t seconds] [name =] function, iterable: map a function over an iterable in forked workers.
+
+    The workers are forked without exec. Once the process has used Grand
+    Central Dispatch, Accelerate or other Apple frameworks, which Liasis
+    itself does, a worker calling into them may crash or deadlock. A worker
+    that crashes is reported with its signal, and with -t, a worker that
+    returns no result for the given number of seconds is killed and the
+    command fails instead of hanging. The output of the workers is written to
+    their stdout and stderr descriptors, which reach the interpreter when the
+    descriptors are captured. The progress is displayed while the workers
+    run, and the interrupt key kills them."""
+    import _liasis_interpreter
+    import cStringIO
+    import multiprocessing
+    import select
+    import struct
+    import time
+    timeout = None
+    match = re.match(r'\s*-t\s+(\d+(?:\.\d*)?)\s+(.*)$', argument, re.DOTALL)
+    if match is not None:
+        timeout, argument = float(match.group(1)), match.group(2)
+    match = re.match(r'([A-Za-z_]\w*)\s*=(?!=)\s*(.*)$', argument, re.DOTALL)
+    target, source = (match.group(1), match.group(2)) if match else (None, argument)
+    function, iterable = eval('(%s)' % source, namespace)
+    items = list(iterable)
+    worker_count = max(1, min(multiprocessing.cpu_count(), len(items)))
+    directory = tempfile.mkdtemp(prefix='liasis-parallel-')
+    workers = {}
+    sys.stdout.flush()
+    for worker in range(worker_count):
+        read_descriptor, write_descriptor = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            status = 0
+            try:
+                os.close(read_descriptor)
+                sys.stdout = os.fdopen(1, 'w', 0)
+                sys.stderr = os.fdopen(2, 'w', 0)
+                _parallel_worker(function, items, range(worker, len(items), worker_count),
+                                 write_descriptor, directory)
+            except BaseException:
+                status = 1
+            finally:
+                os._exit(status)
+        os.close(write_descriptor)
+        workers[read_descriptor] = pid
+
+    def persistent_load(path):
+        array = _numpy().load(path, mmap_mode='r')
+        os.unlink(path)
+        return array
+
+    results = [None] * len(items)
+    errors = []
+    crashes = []
+    done = 0
+    deadline = time.time() + timeout if timeout is not None else None
+    try:
+        while workers:
+            wait = PARALLEL_POLL_INTERVAL
+            if deadline is not None:
+                wait = max(0.0, min(wait, deadline - time.time()))
+            readable, _, _ = select.select(list(workers), [], [], wait)
+            if _liasis_interpreter.display_progress():
+                raise KeyboardInterrupt('%%parallel: interrupted, %d workers killed' % len(workers))
+            if not readable:
+                if deadline is None or time.time() < deadline:
+                    continue
+                raise RuntimeError('%%parallel: no result for %g seconds, %d workers killed; %s'
+                                   % (timeout, len(workers), PARALLEL_FORK_WARNING))
+            if deadline is not None:
+                deadline = time.time() + timeout
+            for descriptor in readable:
+                header = _read_exactly(descriptor, 8)
+                length, = struct.unpack('<Q', header) if len(header) == 8 else (None,)
+                data = _read_exactly(descriptor, length) if length is not None else ''
+                if length is None or len(data) < length:
+                    os.close(descriptor)
+                    _, status = os.waitpid(workers.pop(descriptor), 0)
+                    if os.WIFSIGNALED(status):
+                        crashes.append(os.WTERMSIG(status))
+                    continue
+                unpickler = pickle.Unpickler(cStringIO.StringIO(data))
+                unpickler.persistent_load = persistent_load
+                index, succeeded, value = unpickler.load()
+                if succeeded:
+                    results[index] = value
+                else:
+                    errors.append((index, value))
+                done += 1
+                sys.stdout.write('\r%%parallel: %d/%d on %d workers' % (done, len(items), worker_count))
+    finally:
+        for descriptor, pid in workers.items():
+            os.close(descriptor)
+            os.kill(pid, 9)
+            os.waitpid(pid, 0)
+        shutil.rmtree(directory, ignore_errors=True)
+    sys.stdout.write('\n')
+    if crashes:
+        raise RuntimeError('%%parallel: %d workers crashed (signal %d), %d of %d items processed; %s'
+                           % (len(crashes), crashes[0], done, len(items), PARALLEL_FORK_WARNING))
+    if done < len(items) and not errors:
+        raise RuntimeError('%%parallel: %d of %d items were not processed' % (len(items) - done, len(items)))
+    if errors:
+        index, message = min(errors)
+        raise RuntimeError('%%parallel: item %d failed (%d failures)\n%s' % (index, len(errors), message))
+    _assign_or_display(target, results, namespace)
+
+
+# Output bridging statistics
+
+@magic('copystats')
+def copy_statistics(argument, namespace):
+    """%copystats [reset]: show the copies per byte of output made by the output sink."""
+    import _liasis_interpreter
+    appended, copied = _liasis_interpreter.copy_statistics(argument.strip() == 'reset')
+    if appended == 0:
+        print 'No output since the statistics were reset'
+    else:
+        print '%d bytes of output, %d bytes copied, %.2f copies per byte' % (appended, copied, float(copied) / appended)
+
+
+@magic('break')
+def set_breakpoint(argument, namespace):
+    """%break [function | file:line]: break in a function or at a line of a file, or list the breakpoints."""
+    import _liasis_interpreter
+    import liasis_introspection
+    argument = argument.strip()
+    if not argument:
+        for description in _liasis_interpreter.breakpoints():
+            print description
+        return
+    match = re.match(r'^(.+):(\d+)$', argument)
+    if match is not None:
+        _liasis_interpreter.set_breakpoint(os.path.abspath(os.path.expanduser(match.group(1))), int(match.group(2)))
+        return
+    function = liasis_introspection.resolve(argument, namespace)
+    if isinstance(function, types.MethodType):
+        function = function.im_func
+    code = getattr(function, 'func_code', None)
+    if code is None:
+        sys.stderr.write('%break: %s is not a function or file:line\n' % argument)
+        return
+    _liasis_interpreter.set_breakpoint(code)
+
+
+@magic('clear')
+def clear_breakpoints(argument, namespace):
+    """%clear: remove all breakpoints."""
+    import _liasis_interpreter
+    _liasis_interpreter.clear_breakpoints()
+
+
+@magic('debug')
+def debug(argument, namespace):
+    """%debug statement: run a statement, pausing at the breakpoints."""
+    import _liasis_interpreter
+    _liasis_interpreter.debug(compile(argument, '<string>', 'single'), namespace)
+
+
+# The share of the total time above which a line is highlighted in red, and
+# in yellow, in the %lineprof listing.
+LINEPROF_HOT_FRACTION = 0.2
+LINEPROF_WARM_FRACTION = 0.05
+
+
+@magic('lineprof')
+def line_profile(argument, namespace):
+    """%lineprof -f function [-f function ...] statement: run a statement and show the time spent on each line of the functions."""
+    import _liasis_interpreter
+    import inspect
+    import linecache
+    import liasis_introspection
+    match = re.match(r'^((?:\s*-f\s+\S+)+)\s+(.+)$', argument.strip(), re.DOTALL)
+    if match is None:
+        sys.stderr.write('usage: %lineprof -f function [-f function ...] statement\n')
+        return
+    codes = []
+    for name in re.findall(r'-f\s+(\S+)', match.group(1)):
+        function = liasis_introspection.resolve(name, namespace)
+        if isinstance(function, types.MethodType):
+            function = function.im_func
+        code = getattr(function, 'func_code', None)
+        if code is None:
+            sys.stderr.write('%%lineprof: %s is not a function\n' % name)
+            return
+        codes.append(code)
+    statement = compile(match.group(2), '<string>', 'single')
+    for code, lines in _liasis_interpreter.line_profile(codes, statement, namespace):
+        total = sum(seconds for line, hits, seconds in lines)
+        measured = dict((line, (hits, seconds)) for line, hits, seconds in lines)
+        source = inspect.getblock(linecache.getlines(code.co_filename)[code.co_firstlineno - 1:]) or []
+        print 'Function %s in %s, line %d: %.6f s' % (code.co_name, code.co_filename, code.co_firstlineno, total)
+        print '%6s %10s %12s %10s %7s  %s' % ('Line', 'Hits', 'Time (ms)', 'Per hit', '% Time', 'Source')
+        for offset in range(max(len(source), max(measured.keys() or [code.co_firstlineno]) - code.co_firstlineno + 1)):
+            line = code.co_firstlineno + offset
+            text = source[offset].rstrip('\n') if offset < len(source) else ''
+            if line not in measured:
+                print '%6d %10s %12s %10s %7s  %s' % (line, '', '', '', '', text)
+                continue
+            hits, seconds = measured[line]
+            fraction = seconds / total if total > 0 else 0.0
+            color = '\x1b[31m' if fraction >= LINEPROF_HOT_FRACTION else '\x1b[33m' if fraction >= LINEPROF_WARM_FRACTION else ''
+            print '%s%6d %10d %12.3f %10.3f %7.1f%s  %s' % (color, line, hits, seconds * 1000, seconds * 1000 / hits, fraction * 100,
+                                                           '\x1b[0m' if color else '', text)
+        print
+
+
+@magic('watch')
+def watch(argument, namespace):
+    """%watch expression: show the value of an expression in the watch panel after each command."""
+    import _liasis_interpreter
+    if not argument.strip():
+        sys.stderr.write('usage: %watch expression\n')
+        return
+    _liasis_interpreter.watch(argument.strip())
+
+
+@magic('unwatch')
+def unwatch(argument, namespace):
+    """%unwatch [expression]: remove an expression, or all expressions, from the watch panel."""
+    import _liasis_interpreter
+    if argument.strip():
+        _liasis_interpreter.unwatch(argument.strip())
+    else:
+        _liasis_interpreter.unwatch()
+
+
+@magic('summary')
+def summary(argument, namespace):
+    """%summary [expression]: show the minimum, maximum, mean and NaN count of an array, or of every array in the globals."""
+    import _liasis_interpreter
+    expression = argument.strip()
+    if expression:
+        _liasis_interpreter.summarize(eval(expression, namespace), expression)
+        return
+    for name, value in sorted(namespace.items()):
+        if name.startswith('_') or isinstance(value, (basestring, bytearray, types.ModuleType)):
+            continue
+        try:
+            memoryview(value)
+            _liasis_interpreter.summarize(value, name)
+        except (TypeError, ValueError, BufferError):
+            pass
+
+
+@magic('view')
+def view(argument, namespace):
+    """%view expression: open a DataFrame, a Series or an array in a table viewer."""
+    import _liasis_interpreter
+    expression = argument.strip()
+    if not expression:
+        sys.stderr.write('usage: %view expression\n')
+        return
+    _liasis_interpreter.view(eval(expression, namespace), expression)